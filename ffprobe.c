@@ -352,6 +352,17 @@ typedef struct Writer {
 } Writer;
 
 #define SECTION_MAX_NB_LEVELS 10
+#define SECTION_MAX_NB_CACHED_ENTRIES 64
+
+/**
+ * Resolved entries_to_show lookups of a section. Keys of sections without
+ * variable fields are string constants, so they are identified by address.
+ */
+typedef struct SectionEntryCache {
+    const char *keys[SECTION_MAX_NB_CACHED_ENTRIES];
+    uint8_t show[SECTION_MAX_NB_CACHED_ENTRIES];
+    int nb_keys;
+} SectionEntryCache;
 
 struct WriterContext {
     const AVClass *class;           ///< class of the writer
@@ -361,6 +372,7 @@ struct WriterContext {
 
     const struct section *sections; ///< array containing all sections
     int nb_sections;                ///< number of sections
+    SectionEntryCache *entry_cache; ///< per section selector cache, nb_sections entries
 
     int level;                      ///< current level, starting from 0
 
@@ -429,6 +441,7 @@ static void writer_close(WriterContext **wctx)
         (*wctx)->writer->uninit(*wctx);
     for (i = 0; i < SECTION_MAX_NB_LEVELS; i++)
         av_bprint_finalize(&(*wctx)->section_pbuf[i], NULL);
+    av_freep(&(*wctx)->entry_cache);
     if ((*wctx)->writer->priv_class)
         av_opt_free((*wctx)->priv);
     av_freep(&((*wctx)->priv));
@@ -466,6 +479,11 @@ static int writer_open(WriterContext **wctx, const Writer *writer, const char *a
     (*wctx)->sections = sections;
     (*wctx)->nb_sections = nb_sections;
 
+    if (!((*wctx)->entry_cache = av_mallocz_array(nb_sections, sizeof(*(*wctx)->entry_cache)))) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
     av_opt_set_defaults(*wctx);
 
     if (writer->priv_class) {
@@ -573,12 +591,34 @@ static inline void writer_print_section_footer(WriterContext *wctx)
     wctx->level--;
 }
 
-static inline void writer_print_integer(WriterContext *wctx,
-                                        const char *key, long long int val)
+static inline int writer_show_entry(WriterContext *wctx, const char *key)
 {
     const struct section *section = wctx->section[wctx->level];
+    SectionEntryCache *cache;
+    int i, show;
+
+    if (section->show_all_entries)
+        return 1;
+    if (section->flags & SECTION_FLAG_HAS_VARIABLE_FIELDS)
+        return !!av_dict_get(section->entries_to_show, key, NULL, 0);
 
-    if (section->show_all_entries || av_dict_get(section->entries_to_show, key, NULL, 0)) {
+    cache = &wctx->entry_cache[section->id];
+    for (i = 0; i < cache->nb_keys; i++)
+        if (cache->keys[i] == key)
+            return cache->show[i];
+
+    show = !!av_dict_get(section->entries_to_show, key, NULL, 0);
+    if (cache->nb_keys < SECTION_MAX_NB_CACHED_ENTRIES) {
+        cache->keys[cache->nb_keys] = key;
+        cache->show[cache->nb_keys++] = show;
+    }
+    return show;
+}
+
+static inline void writer_print_integer(WriterContext *wctx,
+                                        const char *key, long long int val)
+{
+    if (writer_show_entry(wctx, key)) {
         wctx->writer->print_integer(wctx, key, val);
         wctx->nb_item[wctx->level]++;
     }
@@ -652,7 +692,7 @@ static inline int writer_print_string(WriterContext *wctx,
         && !(wctx->writer->flags & WRITER_FLAG_DISPLAY_OPTIONAL_FIELDS))
         return 0;
 
-    if (section->show_all_entries || av_dict_get(section->entries_to_show, key, NULL, 0)) {
+    if (writer_show_entry(wctx, key)) {
         if (flags & PRINT_STRING_VALIDATE) {
             char *key1 = NULL, *val1 = NULL;
             ret = validate_string(wctx, &key1, key);
@@ -682,6 +722,9 @@ static inline void writer_print_rational(WriterContext *wctx,
                                          const char *key, AVRational q, char sep)
 {
     AVBPrint buf;
+
+    if (!writer_show_entry(wctx, key))
+        return;
     av_bprint_init(&buf, 0, AV_BPRINT_SIZE_AUTOMATIC);
     av_bprintf(&buf, "%d%c%d", q.num, sep, q.den);
     writer_print_string(wctx, key, buf.str, 0);
@@ -692,6 +735,10 @@ static void writer_print_time(WriterContext *wctx, const char *key,
 {
     char buf[128];
 
+    /* skip the formatting for fields which are not selected */
+    if (!writer_show_entry(wctx, key))
+        return;
+
     if ((!is_duration && ts == AV_NOPTS_VALUE) || (is_duration && ts == 0)) {
         writer_print_string(wctx, key, "N/A", PRINT_STRING_OPT);
     } else {
@@ -983,6 +1030,7 @@ typedef struct CompactContext {
     int nested_section[SECTION_MAX_NB_LEVELS];
     int has_nested_elems[SECTION_MAX_NB_LEVELS];
     int terminate_line[SECTION_MAX_NB_LEVELS];
+    AVBPrint line;              ///< pending output, written out once per line
 } CompactContext;
 
 #undef OFFSET
@@ -1021,9 +1069,25 @@ static av_cold int compact_init(WriterContext *wctx)
         return AVERROR(EINVAL);
     }
 
+    av_bprint_init(&compact->line, 1, AV_BPRINT_SIZE_UNLIMITED);
     return 0;
 }
 
+static void compact_flush_line(CompactContext *compact)
+{
+    if (av_bprint_is_complete(&compact->line))
+        fwrite(compact->line.str, 1, compact->line.len, stdout);
+    av_bprint_clear(&compact->line);
+}
+
+static av_cold void compact_uninit(WriterContext *wctx)
+{
+    CompactContext *compact = wctx->priv;
+
+    compact_flush_line(compact);
+    av_bprint_finalize(&compact->line, NULL);
+}
+
 static void compact_print_section_header(WriterContext *wctx)
 {
     CompactContext *compact = wctx->priv;
@@ -1046,11 +1110,12 @@ static void compact_print_section_header(WriterContext *wctx)
         if (parent_section && compact->has_nested_elems[wctx->level-1] &&
             (section->flags & SECTION_FLAG_IS_ARRAY)) {
             compact->terminate_line[wctx->level-1] = 0;
-            printf("\n");
+            av_bprint_chars(&compact->line, '\n', 1);
+            compact_flush_line(compact);
         }
         if (compact->print_section &&
             !(section->flags & (SECTION_FLAG_IS_WRAPPER|SECTION_FLAG_IS_ARRAY)))
-            printf("%s%c", section->name, compact->item_sep);
+            av_bprintf(&compact->line, "%s%c", section->name, compact->item_sep);
     }
 }
 
@@ -1060,8 +1125,10 @@ static void compact_print_section_footer(WriterContext *wctx)
 
     if (!compact->nested_section[wctx->level] &&
         compact->terminate_line[wctx->level] &&
-        !(wctx->section[wctx->level]->flags & (SECTION_FLAG_IS_WRAPPER|SECTION_FLAG_IS_ARRAY)))
-        printf("\n");
+        !(wctx->section[wctx->level]->flags & (SECTION_FLAG_IS_WRAPPER|SECTION_FLAG_IS_ARRAY))) {
+        av_bprint_chars(&compact->line, '\n', 1);
+        compact_flush_line(compact);
+    }
 }
 
 static void compact_print_str(WriterContext *wctx, const char *key, const char *value)
@@ -1069,11 +1136,11 @@ static void compact_print_str(WriterContext *wctx, const char *key, const char *
     CompactContext *compact = wctx->priv;
     AVBPrint buf;
 
-    if (wctx->nb_item[wctx->level]) printf("%c", compact->item_sep);
+    if (wctx->nb_item[wctx->level]) av_bprint_chars(&compact->line, compact->item_sep, 1);
     if (!compact->nokey)
-        printf("%s%s=", wctx->section_pbuf[wctx->level].str, key);
+        av_bprintf(&compact->line, "%s%s=", wctx->section_pbuf[wctx->level].str, key);
     av_bprint_init(&buf, 1, AV_BPRINT_SIZE_UNLIMITED);
-    printf("%s", compact->escape_str(&buf, value, compact->item_sep, wctx));
+    av_bprintf(&compact->line, "%s", compact->escape_str(&buf, value, compact->item_sep, wctx));
     av_bprint_finalize(&buf, NULL);
 }
 
@@ -1081,16 +1148,17 @@ static void compact_print_int(WriterContext *wctx, const char *key, long long in
 {
     CompactContext *compact = wctx->priv;
 
-    if (wctx->nb_item[wctx->level]) printf("%c", compact->item_sep);
+    if (wctx->nb_item[wctx->level]) av_bprint_chars(&compact->line, compact->item_sep, 1);
     if (!compact->nokey)
-        printf("%s%s=", wctx->section_pbuf[wctx->level].str, key);
-    printf("%lld", value);
+        av_bprintf(&compact->line, "%s%s=", wctx->section_pbuf[wctx->level].str, key);
+    av_bprintf(&compact->line, "%lld", value);
 }
 
 static const Writer compact_writer = {
     .name                 = "compact",
     .priv_size            = sizeof(CompactContext),
     .init                 = compact_init,
+    .uninit               = compact_uninit,
     .print_section_header = compact_print_section_header,
     .print_section_footer = compact_print_section_footer,
     .print_integer        = compact_print_int,
@@ -1122,6 +1190,7 @@ static const Writer csv_writer = {
     .name                 = "csv",
     .priv_size            = sizeof(CompactContext),
     .init                 = compact_init,
+    .uninit               = compact_uninit,
     .print_section_header = compact_print_section_header,
     .print_section_footer = compact_print_section_footer,
     .print_integer        = compact_print_int,
@@ -1710,9 +1779,11 @@ static void writer_register_all(void)
 }
 
 #define print_fmt(k, f, ...) do {              \
-    av_bprint_clear(&pbuf);                    \
-    av_bprintf(&pbuf, f, __VA_ARGS__);         \
-    writer_print_string(w, k, pbuf.str, 0);    \
+    if (writer_show_entry(w, k)) {             \
+        av_bprint_clear(&pbuf);                \
+        av_bprintf(&pbuf, f, __VA_ARGS__);     \
+        writer_print_string(w, k, pbuf.str, 0);\
+    }                                          \
 } while (0)
 
 #define print_int(k, v)         writer_print_integer(w, k, v)
@@ -1728,7 +1799,8 @@ static void writer_register_all(void)
     struct unit_value uv;                                           \
     uv.val.i = v;                                                   \
     uv.unit = u;                                                    \
-    writer_print_string(w, k, value_string(val_str, sizeof(val_str), uv), 0); \
+    if (writer_show_entry(w, k))                                    \
+        writer_print_string(w, k, value_string(val_str, sizeof(val_str), uv), 0); \
 } while (0)
 
 #define print_section_header(s) writer_print_section_header(w, s)
@@ -2073,10 +2145,12 @@ static int read_interval_packets(WriterContext *w, InputFile *ifile,
         }
     }
 
-    frame = av_frame_alloc();
-    if (!frame) {
-        ret = AVERROR(ENOMEM);
-        goto end;
+    if (do_read_frames) {
+        frame = av_frame_alloc();
+        if (!frame) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
     }
     while (!av_read_frame(fmt_ctx, &pkt)) {
         if (ifile->nb_streams > nb_streams) {
@@ -2535,6 +2609,9 @@ static int open_input_file(InputFile *ifile, const char *filename)
     AVDictionaryEntry *t;
     AVDictionary **opts;
     int scan_all_pmts_set = 0;
+    /* Packets and container level information do not need a decoder, only
+     * open them when frames are read or codec properties are printed. */
+    int open_decoders = do_read_frames || do_show_streams || do_show_programs;
 
     if (!av_dict_get(format_opts, "scan_all_pmts", NULL, AV_DICT_MATCH_CASE)) {
         av_dict_set(&format_opts, "scan_all_pmts", "1", AV_DICT_DONT_OVERWRITE);
@@ -2591,6 +2668,9 @@ static int open_input_file(InputFile *ifile, const char *filename)
             continue;
         }
 
+        if (!open_decoders)
+            continue;
+
         codec = avcodec_find_decoder(stream->codecpar->codec_id);
         if (!codec) {
             av_log(NULL, AV_LOG_WARNING,
@@ -1621,6 +1621,13 @@ typedef struct AVPacket {
 } AVPacket;
 #define AV_PKT_FLAG_KEY     0x0001 ///< The packet contains a keyframe
 #define AV_PKT_FLAG_CORRUPT 0x0002 ///< The packet content is corrupted
+/**
+ * The packet comes from a trusted source.
+ *
+ * Otherwise-unsafe constructs such as arbitrary pointers to data
+ * outside the packet may be followed.
+ */
+#define AV_PKT_FLAG_TRUSTED 0x0008
 
 enum AVSideDataParamChangeFlags {
     AV_SIDE_DATA_PARAM_CHANGE_CHANNEL_COUNT  = 0x0001,
@@ -3524,6 +3531,16 @@ typedef struct AVCodecContext {
 #define FF_SUB_TEXT_FMT_ASS_WITH_TIMINGS 1
 #endif
 
+    /**
+     * Maximum number of frames in flight in the frame-threaded encoder of
+     * intra-only codecs; each of them adds one frame of latency. 0 means
+     * one per thread. If lower than thread_count and the encoder supports
+     * slice threading, the remaining threads are used as slice threads
+     * within each frame.
+     * - encoding: set by user
+     * - decoding: unused
+     */
+    int frame_thread_depth;
 } AVCodecContext;
 
 AVRational av_codec_get_pkt_timebase         (const AVCodecContext *avctx);
@@ -45,6 +45,18 @@ void av_fft_calc(FFTContext *s, FFTComplex *z)
     s->fft_calc(s, z);
 }
 
+void av_fft_calc_batch(FFTContext *s, FFTComplex *z, int stride, int nb)
+{
+    void (*fft_permute)(FFTContext *s, FFTComplex *z) = s->fft_permute;
+    void (*fft_calc)(FFTContext *s, FFTComplex *z)    = s->fft_calc;
+    int i;
+
+    for (i = 0; i < nb; i++, z += stride) {
+        fft_permute(s, z);
+        fft_calc(s, z);
+    }
+}
+
 av_cold void av_fft_end(FFTContext *s)
 {
     if (s) {
@@ -107,6 +119,15 @@ void av_rdft_calc(RDFTContext *s, FFTSample *data)
     s->rdft_calc(s, data);
 }
 
+void av_rdft_calc_batch(RDFTContext *s, FFTSample *data, int stride, int nb)
+{
+    void (*rdft_calc)(RDFTContext *s, FFTSample *z) = s->rdft_calc;
+    int i;
+
+    for (i = 0; i < nb; i++, data += stride)
+        rdft_calc(s, data);
+}
+
 av_cold void av_rdft_end(RDFTContext *s)
 {
     if (s) {
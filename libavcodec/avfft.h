@@ -58,6 +58,18 @@ void av_fft_permute(FFTContext *s, FFTComplex *z);
  */
 void av_fft_calc(FFTContext *s, FFTComplex *z);
 
+/**
+ * Permute and transform nb arrays of the same size in one call.
+ *
+ * This is equivalent to calling av_fft_permute() and av_fft_calc() on
+ * z, z + stride, ..., z + (nb - 1) * stride.
+ *
+ * @param stride distance between the start of two arrays, in FFTComplex
+ *               units; must be at least the transform size
+ * @param nb     number of arrays to transform
+ */
+void av_fft_calc_batch(FFTContext *s, FFTComplex *z, int stride, int nb);
+
 void av_fft_end(FFTContext *s);
 
 FFTContext *av_mdct_init(int nbits, int inverse, double scale);
@@ -84,6 +96,18 @@ typedef struct RDFTContext RDFTContext;
  */
 RDFTContext *av_rdft_init(int nbits, enum RDFTransformType trans);
 void av_rdft_calc(RDFTContext *s, FFTSample *data);
+
+/**
+ * Transform nb arrays of the same size in one call.
+ *
+ * This is equivalent to calling av_rdft_calc() on
+ * data, data + stride, ..., data + (nb - 1) * stride.
+ *
+ * @param stride distance between the start of two arrays, in FFTSample
+ *               units; must be at least the transform size
+ * @param nb     number of arrays to transform
+ */
+void av_rdft_calc_batch(RDFTContext *s, FFTSample *data, int stride, int nb);
 void av_rdft_end(RDFTContext *s);
 
 /* Discrete Cosine Transform */
@@ -23,6 +23,7 @@
 #include "libavutil/fifo.h"
 #include "libavutil/avassert.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/opt.h"
 #include "libavutil/thread.h"
 #include "avcodec.h"
 #include "internal.h"
@@ -32,10 +33,11 @@
 #define BUFFER_SIZE (2*MAX_THREADS)
 
 typedef struct{
-    void *indata;
-    void *outdata;
+    AVFrame *indata;
+    AVPacket *outdata;
     int64_t return_code;
     unsigned index;
+    int finished;
 } Task;
 
 typedef struct{
@@ -50,27 +52,29 @@ typedef struct{
     pthread_mutex_t finished_task_mutex;
     pthread_cond_t finished_task_cond;
 
+    /* Per-slot frames and packets, reused for the whole session. */
+    AVFrame *frames[BUFFER_SIZE];
+    AVPacket packets[BUFFER_SIZE];
+
     unsigned task_index;
     unsigned finished_task_index;
+    unsigned depth;             ///< maximum number of frames in flight
 
     pthread_t worker[MAX_THREADS];
+    int nb_workers;
     int exit;
 } ThreadContext;
 
 static void * attribute_align_arg worker(void *v){
     AVCodecContext *avctx = v;
     ThreadContext *c = avctx->internal->frame_thread_encoder;
-    AVPacket *pkt = NULL;
 
     while(!c->exit){
         int got_packet, ret;
         AVFrame *frame;
+        AVPacket *pkt;
         Task task;
 
-        if(!pkt) pkt= av_mallocz(sizeof(*pkt));
-        if(!pkt) continue;
-        av_init_packet(pkt);
-
         pthread_mutex_lock(&c->task_fifo_mutex);
         while (av_fifo_size(c->task_fifo) <= 0 || c->exit) {
             if(c->exit){
@@ -82,12 +86,15 @@ static void * attribute_align_arg worker(void *v){
         av_fifo_generic_read(c->task_fifo, &task, sizeof(task), NULL);
         pthread_mutex_unlock(&c->task_fifo_mutex);
         frame = task.indata;
+        pkt   = &c->packets[task.index];
+        av_init_packet(pkt);
+        pkt->data = NULL;
+        pkt->size = 0;
 
         ret = avcodec_encode_video2(avctx, pkt, frame, &got_packet);
         pthread_mutex_lock(&c->buffer_mutex);
         av_frame_unref(frame);
         pthread_mutex_unlock(&c->buffer_mutex);
-        av_frame_free(&frame);
         if(got_packet) {
             int ret2 = av_dup_packet(pkt);
             if (ret >= 0 && ret2 < 0)
@@ -97,13 +104,16 @@ static void * attribute_align_arg worker(void *v){
             pkt->size = 0;
         }
         pthread_mutex_lock(&c->finished_task_mutex);
-        c->finished_tasks[task.index].outdata = pkt; pkt = NULL;
+        c->finished_tasks[task.index].outdata = pkt;
         c->finished_tasks[task.index].return_code = ret;
+        c->finished_tasks[task.index].finished = 1;
         pthread_cond_signal(&c->finished_task_cond);
         pthread_mutex_unlock(&c->finished_task_mutex);
     }
 end:
-    av_free(pkt);
+    /* Workers may run slice threads, keep avcodec_close() from tearing
+     * down the shared context. */
+    avctx->internal->frame_thread_encoder = NULL;
     pthread_mutex_lock(&c->buffer_mutex);
     avcodec_close(avctx);
     pthread_mutex_unlock(&c->buffer_mutex);
@@ -113,6 +123,8 @@ end:
 
 int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
     int i=0;
+    int nb_workers, slice_threads = 1;
+    unsigned depth;
     ThreadContext *c;
 
 
@@ -170,12 +182,41 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
     if(avctx->thread_count > MAX_THREADS)
         return AVERROR(EINVAL);
 
+    /* Every frame in flight adds one frame of latency. With fewer frames in
+     * flight than threads, the remaining threads are used for slice
+     * threading inside each frame if the encoder supports it. */
+    nb_workers = avctx->thread_count;
+    if (avctx->flags & AV_CODEC_FLAG_LOW_DELAY)
+        depth = 1;
+    else if (avctx->frame_thread_depth > 0)
+        /* one more frame than the depth is submitted before the oldest
+         * packet is returned, and a full ring would look empty */
+        depth = FFMIN(avctx->frame_thread_depth, BUFFER_SIZE - 2);
+    else
+        depth = nb_workers;
+    if (depth < nb_workers) {
+        if (   avctx->codec->capabilities & AV_CODEC_CAP_SLICE_THREADS
+            && avctx->thread_type & FF_THREAD_SLICE)
+            slice_threads = nb_workers / depth;
+        nb_workers = depth;
+    }
+
+    if (nb_workers <= 1) {
+        /* Nothing to gain from a single frame worker, leave the threads
+         * to slice threading in the main context. */
+        avctx->thread_type &= ~FF_THREAD_FRAME;
+        if (slice_threads <= 1)
+            avctx->thread_count = 1;
+        return 0;
+    }
+
     av_assert0(!avctx->internal->frame_thread_encoder);
     c = avctx->internal->frame_thread_encoder = av_mallocz(sizeof(ThreadContext));
     if(!c)
         return AVERROR(ENOMEM);
 
     c->parent_avctx = avctx;
+    c->depth        = depth;
 
     c->task_fifo = av_fifo_alloc_array(BUFFER_SIZE, sizeof(Task));
     if(!c->task_fifo)
@@ -187,7 +228,14 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
     pthread_cond_init(&c->task_fifo_cond, NULL);
     pthread_cond_init(&c->finished_task_cond, NULL);
 
-    for(i=0; i<avctx->thread_count ; i++){
+    for (i = 0; i < BUFFER_SIZE; i++) {
+        c->frames[i] = av_frame_alloc();
+        if (!c->frames[i])
+            goto fail;
+        av_init_packet(&c->packets[i]);
+    }
+
+    for(i=0; i<nb_workers; i++){
         AVDictionary *tmp = NULL;
         void *tmpv;
         AVCodecContext *thread_avctx = avcodec_alloc_context3(avctx->codec);
@@ -197,12 +245,19 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
         *thread_avctx = *avctx;
         thread_avctx->priv_data = tmpv;
         thread_avctx->internal = NULL;
-        memcpy(thread_avctx->priv_data, avctx->priv_data, avctx->codec->priv_data_size);
-        thread_avctx->thread_count = 1;
+        if (avctx->codec->priv_class) {
+            /* Deep copy, string options must not be shared with the parent. */
+            if (av_opt_copy(thread_avctx->priv_data, avctx->priv_data) < 0)
+                goto fail;
+        } else
+            memcpy(thread_avctx->priv_data, avctx->priv_data, avctx->codec->priv_data_size);
+        thread_avctx->thread_count = slice_threads;
+        thread_avctx->thread_type  = FF_THREAD_SLICE;
         thread_avctx->active_thread_type &= ~FF_THREAD_FRAME;
 
         av_dict_copy(&tmp, options, 0);
-        av_dict_set(&tmp, "threads", "1", 0);
+        av_dict_set_int(&tmp, "threads", slice_threads, 0);
+        av_dict_set(&tmp, "thread_type", "slice", 0);
         if(avcodec_open2(thread_avctx, avctx->codec, &tmp) < 0) {
             av_dict_free(&tmp);
             goto fail;
@@ -213,13 +268,15 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
         if(pthread_create(&c->worker[i], NULL, worker, thread_avctx)) {
             goto fail;
         }
+        c->nb_workers++;
     }
 
+    av_log(avctx, AV_LOG_DEBUG, "Frame threading with %d workers, %d slice threads each, %u frames in flight\n",
+           nb_workers, slice_threads, depth);
     avctx->active_thread_type = FF_THREAD_FRAME;
 
     return 0;
 fail:
-    avctx->thread_count = i;
     av_log(avctx, AV_LOG_ERROR, "ff_frame_thread_encoder_init failed\n");
     ff_frame_thread_encoder_free(avctx);
     return -1;
@@ -234,10 +291,15 @@ void ff_frame_thread_encoder_free(AVCodecContext *avctx){
     pthread_cond_broadcast(&c->task_fifo_cond);
     pthread_mutex_unlock(&c->task_fifo_mutex);
 
-    for (i=0; i<avctx->thread_count; i++) {
+    for (i=0; i<c->nb_workers; i++) {
          pthread_join(c->worker[i], NULL);
     }
 
+    for (i = 0; i < BUFFER_SIZE; i++) {
+        av_frame_free(&c->frames[i]);
+        av_packet_unref(&c->packets[i]);
+    }
+
     pthread_mutex_destroy(&c->task_fifo_mutex);
     pthread_mutex_destroy(&c->finished_task_mutex);
     pthread_mutex_destroy(&c->buffer_mutex);
@@ -255,17 +317,16 @@ int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt, const AVF
     av_assert1(!*got_packet_ptr);
 
     if(frame){
-        AVFrame *new = av_frame_alloc();
-        if(!new)
-            return AVERROR(ENOMEM);
+        AVFrame *new = c->frames[c->task_index];
+
+        /* The worker only needs a reference, the data is not copied for
+         * refcounted frames. */
         ret = av_frame_ref(new, frame);
-        if(ret < 0) {
-            av_frame_free(&new);
+        if(ret < 0)
             return ret;
-        }
 
         task.index = c->task_index;
-        task.indata = (void*)new;
+        task.indata = new;
         pthread_mutex_lock(&c->task_fifo_mutex);
         av_fifo_generic_write(c->task_fifo, &task, sizeof(task), NULL);
         pthread_cond_signal(&c->task_fifo_cond);
@@ -273,7 +334,7 @@ int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt, const AVF
 
         c->task_index = (c->task_index+1) % BUFFER_SIZE;
 
-        if(!c->finished_tasks[c->finished_task_index].outdata && (c->task_index - c->finished_task_index) % BUFFER_SIZE <= avctx->thread_count)
+        if(!c->finished_tasks[c->finished_task_index].finished && (c->task_index - c->finished_task_index) % BUFFER_SIZE <= c->depth)
             return 0;
     }
 
@@ -281,14 +342,14 @@ int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt, const AVF
         return 0;
 
     pthread_mutex_lock(&c->finished_task_mutex);
-    while (!c->finished_tasks[c->finished_task_index].outdata) {
+    while (!c->finished_tasks[c->finished_task_index].finished) {
         pthread_cond_wait(&c->finished_task_cond, &c->finished_task_mutex);
     }
     task = c->finished_tasks[c->finished_task_index];
-    *pkt = *(AVPacket*)(task.outdata);
+    av_packet_move_ref(pkt, task.outdata);
     if(pkt->data)
         *got_packet_ptr = 1;
-    av_freep(&c->finished_tasks[c->finished_task_index].outdata);
+    c->finished_tasks[c->finished_task_index].finished = 0;
     c->finished_task_index = (c->finished_task_index+1) % BUFFER_SIZE;
     pthread_mutex_unlock(&c->finished_task_mutex);
 
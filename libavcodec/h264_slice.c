@@ -2242,6 +2242,44 @@ static int fill_filter_caches(const H264Context *h, H264SliceContext *sl, int mb
     return 0;
 }
 
+/**
+ * Hand the macroblocks of the current row before end_x over to the
+ * deblocking job.
+ */
+static void deblock_submit(const H264Context *h, H264SliceContext *sl, int end_x)
+{
+#if HAVE_THREADS
+    H264DeblockContext *dc = sl->deblock;
+
+    pthread_mutex_lock(&dc->lock);
+    dc->decoded = end_x + sl->mb_y * h->mb_width;
+    pthread_cond_broadcast(&dc->cond);
+    pthread_mutex_unlock(&dc->lock);
+#endif
+}
+
+/**
+ * Wait until the row above is deblocked up to the top right macroblock.
+ * The intra prediction of the current macroblock swaps the unfiltered top
+ * borders saved by loop_filter() into these pixels, see xchg_mb_border().
+ */
+static av_always_inline void deblock_await(const H264Context *h, H264SliceContext *sl)
+{
+    H264DeblockContext *dc = sl->deblock;
+    int pos = (sl->mb_y - 1) * h->mb_width + FFMIN(sl->mb_x + 2, h->mb_width);
+
+    if (dc->deblocked_seen >= pos)
+        return;
+
+#if HAVE_THREADS
+    pthread_mutex_lock(&dc->lock);
+    while (dc->deblocked < pos)
+        pthread_cond_wait(&dc->cond, &dc->lock);
+    dc->deblocked_seen = dc->deblocked;
+    pthread_mutex_unlock(&dc->lock);
+#endif
+}
+
 static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x, int end_x)
 {
     uint8_t *dest_y, *dest_cb, *dest_cr;
@@ -2254,6 +2292,11 @@ static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x,
     if (h->postpone_filter)
         return;
 
+    if (sl->deblock) {
+        deblock_submit(h, sl, end_x);
+        return;
+    }
+
     if (sl->deblocking_filter) {
         for (mb_x = start_x; mb_x < end_x; mb_x++)
             for (mb_y = end_mb_y - FRAME_MBAFF(h); mb_y <= end_mb_y; mb_y++) {
@@ -2332,6 +2375,10 @@ static void decode_finish_row(const H264Context *h, H264SliceContext *sl)
     int height         =  16      << FRAME_MBAFF(h);
     int deblock_border = (16 + 4) << FRAME_MBAFF(h);
 
+    /* the row is not deblocked yet, the deblocking job finishes it */
+    if (sl->deblock)
+        return;
+
     if (sl->deblocking_filter) {
         if ((top + height) >= pic_height)
             height += deblock_border;
@@ -2432,8 +2479,11 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
             ret = ff_h264_decode_mb_cabac(h, sl);
             // STOP_TIMER("decode_mb_cabac")
 
-            if (ret >= 0)
+            if (ret >= 0) {
+                if (sl->deblock && sl->mb_y)
+                    deblock_await(h, sl);
                 ff_h264_hl_decode_mb(h, sl);
+            }
 
             // FIXME optimal? or let mb_decode decode 16x32 ?
             if (ret >= 0 && FRAME_MBAFF(h)) {
@@ -2503,8 +2553,11 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
 
             ret = ff_h264_decode_mb_cavlc(h, sl);
 
-            if (ret >= 0)
+            if (ret >= 0) {
+                if (sl->deblock && sl->mb_y)
+                    deblock_await(h, sl);
                 ff_h264_hl_decode_mb(h, sl);
+            }
 
             // FIXME optimal? or let mb_decode decode 16x32 ?
             if (ret >= 0 && FRAME_MBAFF(h)) {
@@ -2579,6 +2632,91 @@ finish:
     return 0;
 }
 
+#if HAVE_THREADS
+static int deblock_slice(H264DeblockContext *dc)
+{
+    H264SliceContext *sl = &dc->sl;
+    const H264Context *h = sl->h264;
+    int pos = dc->deblocked, end;
+
+    for (;;) {
+        pthread_mutex_lock(&dc->lock);
+        while (dc->decoded <= pos && !dc->decoded_last)
+            pthread_cond_wait(&dc->cond, &dc->lock);
+        end = dc->decoded;
+        pthread_mutex_unlock(&dc->lock);
+
+        if (pos >= end)
+            return 0;
+
+        for (; pos < end; pos++) {
+            int mb_x = pos % h->mb_width;
+
+            sl->mb_y = pos / h->mb_width;
+            loop_filter(h, sl, mb_x, mb_x + 1);
+            if (mb_x == h->mb_width - 1)
+                decode_finish_row(h, sl);
+
+            pthread_mutex_lock(&dc->lock);
+            dc->deblocked = pos + 1;
+            pthread_cond_broadcast(&dc->cond);
+            pthread_mutex_unlock(&dc->lock);
+        }
+    }
+}
+
+static int decode_slice_job(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    H264Context *h = arg;
+    H264DeblockContext *dc = h->deblock_ctx;
+    int ret;
+
+    if (jobnr)
+        return deblock_slice(dc);
+
+    ret = decode_slice(avctx, &h->slice_ctx[0]);
+
+    pthread_mutex_lock(&dc->lock);
+    dc->decoded_last = 1;
+    pthread_cond_broadcast(&dc->cond);
+    pthread_mutex_unlock(&dc->lock);
+
+    return ret;
+}
+
+/**
+ * Decode the first slice context and deblock it in a second job, so that a
+ * picture coded as a single slice still uses two threads.
+ */
+static int decode_slice_deblock_threaded(H264Context *h)
+{
+    H264SliceContext *sl   = &h->slice_ctx[0];
+    H264DeblockContext *dc = h->deblock_ctx;
+    int ret[2] = { 0 };
+    int err;
+
+    /* the deblocking job works on a copy of the slice context, it must
+     * share the top borders with the decoding one */
+    sl->linesize   = h->cur_pic_ptr->f->linesize[0];
+    sl->uvlinesize = h->cur_pic_ptr->f->linesize[1];
+    err = alloc_scratch_buffers(sl, sl->linesize);
+    if (err < 0)
+        return err;
+
+    dc->sl             = *sl;
+    dc->decoded        =
+    dc->deblocked      =
+    dc->deblocked_seen = sl->mb_x + sl->mb_y * h->mb_width;
+    dc->decoded_last   = 0;
+    sl->deblock        = dc;
+
+    h->avctx->execute2(h->avctx, decode_slice_job, h, ret, 2);
+
+    sl->deblock = NULL;
+    return ret[0];
+}
+#endif
+
 /**
  * Call decode_slice() for each context.
  *
@@ -2607,6 +2745,12 @@ int ff_h264_execute_decode_slices(H264Context *h, unsigned context_count)
         h->slice_ctx[0].next_slice_idx = h->mb_width * h->mb_height;
         h->postpone_filter = 0;
 
+#if HAVE_THREADS
+        if (h->deblock_ctx && h->slice_ctx[0].deblocking_filter &&
+            !FIELD_OR_MBAFF_PICTURE(h))
+            ret = decode_slice_deblock_threaded(h);
+        else
+#endif
         ret = decode_slice(avctx, &h->slice_ctx[0]);
         h->mb_y = h->slice_ctx[0].mb_y;
         return ret;
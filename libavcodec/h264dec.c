@@ -337,6 +337,16 @@ static int h264_init_context(AVCodecContext *avctx, H264Context *h)
         return AVERROR(ENOMEM);
     }
 
+#if HAVE_THREADS
+    if ((avctx->active_thread_type & FF_THREAD_SLICE) && avctx->thread_count > 1) {
+        h->deblock_ctx = av_mallocz(sizeof(*h->deblock_ctx));
+        if (!h->deblock_ctx)
+            return AVERROR(ENOMEM);
+        pthread_mutex_init(&h->deblock_ctx->lock, NULL);
+        pthread_cond_init(&h->deblock_ctx->cond, NULL);
+    }
+#endif
+
     for (i = 0; i < H264_MAX_PICTURE_COUNT; i++) {
         h->DPB[i].f = av_frame_alloc();
         if (!h->DPB[i].f)
@@ -376,6 +386,14 @@ static av_cold int h264_decode_end(AVCodecContext *avctx)
     av_freep(&h->slice_ctx);
     h->nb_slice_ctx = 0;
 
+#if HAVE_THREADS
+    if (h->deblock_ctx) {
+        pthread_mutex_destroy(&h->deblock_ctx->lock);
+        pthread_cond_destroy(&h->deblock_ctx->cond);
+    }
+#endif
+    av_freep(&h->deblock_ctx);
+
     ff_h264_sei_uninit(&h->sei);
     ff_h264_ps_uninit(&h->ps);
 
@@ -199,6 +199,11 @@ typedef struct H264SliceContext {
     int deblocking_filter;          ///< disable_deblocking_filter_idc with 1 <-> 0
     int slice_alpha_c0_offset;
     int slice_beta_offset;
+    /**
+     * Set while the slice is deblocked by a separate job, then loop_filter()
+     * only hands the macroblocks over to it.
+     */
+    struct H264DeblockContext *deblock;
 
     H264PredWeightTable pwt;
 
@@ -337,6 +342,23 @@ typedef struct H264SliceContext {
     int max_pic_num;
 } H264SliceContext;
 
+/**
+ * Deblocking of a slice running in parallel to its decoding, one macroblock
+ * row behind. Used with slice threading for pictures which are decoded as
+ * a single slice.
+ */
+typedef struct H264DeblockContext {
+    H264SliceContext sl;    ///< copy of the decoding slice context used by the deblocking job
+#if HAVE_THREADS
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+#endif
+    int decoded;            ///< macroblocks before this index (mb_x + mb_y * mb_width) are ready for deblocking
+    int deblocked;          ///< macroblocks before this index are deblocked
+    int decoded_last;       ///< set when decoded will not change anymore
+    int deblocked_seen;     ///< last value of deblocked seen by the decoding job
+} H264DeblockContext;
+
 /**
  * H264Context
  */
@@ -356,6 +378,8 @@ typedef struct H264Context {
     H264SliceContext *slice_ctx;
     int            nb_slice_ctx;
 
+    H264DeblockContext *deblock_ctx;
+
     H2645Packet pkt;
 
     int pixel_shift;    ///< 0 for 8-bit H.264, 1 for high-bit-depth H.264
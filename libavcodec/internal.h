@@ -173,6 +173,12 @@ typedef struct AVCodecInternal {
     int buffer_pkt_valid; // encoding: packet without data can be valid
     AVFrame *buffer_frame;
     int draining_done;
+
+    /**
+     * pool for the motion vectors exported as frame side data
+     */
+    AVBufferPool *mvs_pool;
+    int mvs_pool_size;
 } AVCodecInternal;
 
 struct AVCodecDefault {
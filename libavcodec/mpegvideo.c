@@ -1573,6 +1573,24 @@ static int add_mb(AVMotionVector *mb, uint32_t mb_type,
     return 1;
 }
 
+/**
+ * Get a buffer for size bytes of exported motion vectors, the buffers are
+ * reused as long as the size does not change.
+ */
+static AVBufferRef *get_mvs_buffer(AVCodecContext *avctx, int size)
+{
+    AVCodecInternal *avci = avctx->internal;
+
+    if (!avci->mvs_pool || avci->mvs_pool_size != size) {
+        av_buffer_pool_uninit(&avci->mvs_pool);
+        avci->mvs_pool = av_buffer_pool_init(size, NULL);
+        if (!avci->mvs_pool)
+            return NULL;
+        avci->mvs_pool_size = size;
+    }
+    return av_buffer_pool_get(avci->mvs_pool);
+}
+
 /**
  * Print debugging info for the given picture.
  */
@@ -1588,12 +1606,17 @@ void ff_print_debug_info2(AVCodecContext *avctx, AVFrame *pict, uint8_t *mbskip_
         const int mv_stride      = (mb_width << mv_sample_log2) +
                                    (avctx->codec->id == AV_CODEC_ID_H264 ? 0 : 1);
         int mb_x, mb_y, mbcount = 0;
+        AVMotionVector *mvs;
+        AVBufferRef *buf;
 
         /* size is width * height * 2 * 4 where 2 is for directions and 4 is
          * for the maximum number of MB (4 MB in case of IS_8x8) */
-        AVMotionVector *mvs = av_malloc_array(mb_width * mb_height, 2 * 4 * sizeof(AVMotionVector));
-        if (!mvs)
+        if (mb_width * mb_height > INT_MAX / (2 * 4 * sizeof(AVMotionVector)))
+            return;
+        buf = get_mvs_buffer(avctx, mb_width * mb_height * 2 * 4 * sizeof(AVMotionVector));
+        if (!buf)
             return;
+        mvs = (AVMotionVector *)buf->data;
 
         for (mb_y = 0; mb_y < mb_height; mb_y++) {
             for (mb_x = 0; mb_x < mb_width; mb_x++) {
@@ -1653,15 +1676,15 @@ void ff_print_debug_info2(AVCodecContext *avctx, AVFrame *pict, uint8_t *mbskip_
             AVFrameSideData *sd;
 
             av_log(avctx, AV_LOG_DEBUG, "Adding %d MVs info to frame %d\n", mbcount, avctx->frame_number);
-            sd = av_frame_new_side_data(pict, AV_FRAME_DATA_MOTION_VECTORS, mbcount * sizeof(AVMotionVector));
+            sd = av_frame_new_side_data_from_buf(pict, AV_FRAME_DATA_MOTION_VECTORS, buf);
             if (!sd) {
-                av_freep(&mvs);
+                av_buffer_unref(&buf);
                 return;
             }
-            memcpy(sd->data, mvs, mbcount * sizeof(AVMotionVector));
+            sd->size = mbcount * sizeof(AVMotionVector);
+        } else {
+            av_buffer_unref(&buf);
         }
-
-        av_freep(&mvs);
     }
 
     /* TODO: export all the following to make them accessible for users (and filters) */
@@ -153,6 +153,11 @@ typedef struct OpusStreamContext {
     OpusPacket packet;
 
     int redundancy_idx;
+
+    /* the sub-packet to decode, set up before the streams are decoded in parallel */
+    const uint8_t *input;
+    int input_size;
+    int coded_samples;
 } OpusStreamContext;
 
 // a mapping between an opus stream and an output channel
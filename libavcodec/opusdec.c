@@ -444,6 +444,16 @@ finish:
     return output_samples;
 }
 
+static int opus_decode_substream(AVCodecContext *avctx, void *arg)
+{
+    OpusContext       *c = avctx->priv_data;
+    OpusStreamContext *s = arg;
+    int i = s - c->streams;
+
+    return opus_decode_subpacket(s, s->input, s->input_size,
+                                 c->out + 2 * i, c->out_size[i], s->coded_samples);
+}
+
 static int opus_decode_packet(AVCodecContext *avctx, void *data,
                               int *got_frame_ptr, AVPacket *avpkt)
 {
@@ -529,7 +539,7 @@ static int opus_decode_packet(AVCodecContext *avctx, void *data,
         c->out_size[i] = frame->linesize[0] - ret * sizeof(float);
     }
 
-    /* decode each sub-packet */
+    /* parse the sub-packet headers */
     for (i = 0; i < c->nb_streams; i++) {
         OpusStreamContext *s = &c->streams[i];
 
@@ -548,15 +558,24 @@ static int opus_decode_packet(AVCodecContext *avctx, void *data,
             s->silk_samplerate = get_silk_samplerate(s->packet.config);
         }
 
-        ret = opus_decode_subpacket(&c->streams[i], buf, s->packet.data_size,
-                                    c->out + 2 * i, c->out_size[i], coded_samples);
-        if (ret < 0)
-            return ret;
-        c->decoded_samples[i] = ret;
-        decoded_samples       = FFMIN(decoded_samples, ret);
+        s->input         = buf;
+        s->input_size    = s->packet.data_size;
+        s->coded_samples = coded_samples;
 
-        buf      += s->packet.packet_size;
-        buf_size -= s->packet.packet_size;
+        if (buf) {
+            buf      += s->packet.packet_size;
+            buf_size -= s->packet.packet_size;
+        }
+    }
+
+    /* decode each sub-packet, the streams are independent of each other */
+    avctx->execute(avctx, opus_decode_substream, c->streams, c->decoded_samples,
+                   c->nb_streams, sizeof(*c->streams));
+
+    for (i = 0; i < c->nb_streams; i++) {
+        if (c->decoded_samples[i] < 0)
+            return c->decoded_samples[i];
+        decoded_samples = FFMIN(decoded_samples, c->decoded_samples[i]);
     }
 
     /* buffer the extra samples */
@@ -756,5 +775,5 @@ AVCodec ff_opus_decoder = {
     .close           = opus_decode_close,
     .decode          = opus_decode_packet,
     .flush           = opus_decode_flush,
-    .capabilities    = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY,
+    .capabilities    = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY | AV_CODEC_CAP_SLICE_THREADS,
 };
@@ -28,7 +28,9 @@
 
 #define LONG_BITSTREAM_READER
 
+#include "libavutil/avassert.h"
 #include "libavutil/internal.h"
+#include "libavutil/thread.h"
 #include "avcodec.h"
 #include "get_bits.h"
 #include "idctdsp.h"
@@ -36,6 +38,7 @@
 #include "simple_idct.h"
 #include "proresdec.h"
 #include "proresdata.h"
+#include "thread.h"
 
 static void permute(uint8_t *dst, const uint8_t *src, const uint8_t permutation[64])
 {
@@ -44,6 +47,69 @@ static void permute(uint8_t *dst, const uint8_t *src, const uint8_t permutation[
         dst[i] = permutation[src[i]];
 }
 
+// adaptive codebook switching lut according to previous run/level values
+static const uint8_t run_to_cb[16] = { 0x06, 0x06, 0x05, 0x05, 0x04, 0x29, 0x29, 0x29, 0x29, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x4C };
+static const uint8_t lev_to_cb[10] = { 0x04, 0x0A, 0x05, 0x06, 0x04, 0x28, 0x28, 0x28, 0x28, 0x4C };
+
+/* The AC codewords of up to AC_LUT_BITS bits, the most common ones, are
+ * decoded with a single table lookup. An entry holds value << 4 | length, or 0
+ * if the codeword is longer and has to be decoded with DECODE_CODEWORD(). */
+#define AC_LUT_BITS 8
+
+static const uint8_t ac_codebooks[7] = { 0x04, 0x05, 0x06, 0x0A, 0x28, 0x29, 0x4C };
+static uint16_t ac_lut[FF_ARRAY_ELEMS(ac_codebooks)][1 << AC_LUT_BITS];
+static uint8_t run_to_lut[16];
+static uint8_t lev_to_lut[10];
+static AVOnce init_static_once = AV_ONCE_INIT;
+
+static av_cold uint8_t find_ac_lut(uint8_t codebook)
+{
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(ac_codebooks); i++)
+        if (ac_codebooks[i] == codebook)
+            return i;
+    av_assert0(0);
+    return 0;
+}
+
+static av_cold void init_static_data(void)
+{
+    int i, code;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(ac_codebooks); i++) {
+        unsigned switch_bits =  ac_codebooks[i] & 3;
+        unsigned rice_order  =  ac_codebooks[i] >> 5;
+        unsigned exp_order   = (ac_codebooks[i] >> 2) & 7;
+
+        /* code 0 would need more than AC_LUT_BITS bits in any codebook */
+        for (code = 1; code < 1 << AC_LUT_BITS; code++) {
+            unsigned q = AC_LUT_BITS - 1 - av_log2(code);
+            unsigned len, val;
+
+            if (q > switch_bits) {
+                len = exp_order - switch_bits + (q << 1);
+                if (len > AC_LUT_BITS)
+                    continue;
+                val = (code >> (AC_LUT_BITS - len)) - (1 << exp_order) +
+                      ((switch_bits + 1) << rice_order);
+            } else {
+                len = q + 1 + rice_order;
+                if (len > AC_LUT_BITS)
+                    continue;
+                val = (q << rice_order) +
+                      ((code >> (AC_LUT_BITS - len)) & ((1 << rice_order) - 1));
+            }
+            ac_lut[i][code] = val << 4 | len;
+        }
+    }
+
+    for (i = 0; i < FF_ARRAY_ELEMS(run_to_lut); i++)
+        run_to_lut[i] = find_ac_lut(run_to_cb[i]);
+    for (i = 0; i < FF_ARRAY_ELEMS(lev_to_lut); i++)
+        lev_to_lut[i] = find_ac_lut(lev_to_cb[i]);
+}
+
 static av_cold int decode_init(AVCodecContext *avctx)
 {
     ProresContext *ctx = avctx->priv_data;
@@ -60,8 +126,23 @@ static av_cold int decode_init(AVCodecContext *avctx)
     permute(ctx->progressive_scan, ff_prores_progressive_scan, idct_permutation);
     permute(ctx->interlaced_scan, ff_prores_interlaced_scan, idct_permutation);
 
+    ff_thread_once(&init_static_once, init_static_data);
+
+    return 0;
+}
+
+#if HAVE_THREADS
+static av_cold int decode_init_thread_copy(AVCodecContext *avctx)
+{
+    ProresContext *ctx = avctx->priv_data;
+
+    /* the slices are allocated per thread */
+    ctx->slices      = NULL;
+    ctx->slice_count = 0;
+
     return 0;
 }
+#endif
 
 static int decode_frame_header(ProresContext *ctx, const uint8_t *buf,
                                const int data_size, AVCodecContext *avctx)
@@ -312,9 +393,22 @@ static av_always_inline void decode_dc_coeffs(GetBitContext *gb, int16_t *out,
     CLOSE_READER(re, gb);
 }
 
-// adaptive codebook switching lut according to previous run/level values
-static const uint8_t run_to_cb[16] = { 0x06, 0x06, 0x05, 0x05, 0x04, 0x29, 0x29, 0x29, 0x29, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x4C };
-static const uint8_t lev_to_cb[10] = { 0x04, 0x0A, 0x05, 0x06, 0x04, 0x28, 0x28, 0x28, 0x28, 0x4C };
+/* expects the cache to hold the bits of the codeword, which is true for two
+ * table decoded codewords and a sign bit after a refill; refills the cache
+ * after a long codeword */
+#define DECODE_AC_CODEWORD(val, ctx_idx, to_cb, to_lut)                 \
+    do {                                                                \
+        unsigned idx = ctx_idx, entry;                                  \
+                                                                        \
+        entry = ac_lut[to_lut[idx]][SHOW_UBITS(re, gb, AC_LUT_BITS)];   \
+        if (entry) {                                                    \
+            val = entry >> 4;                                           \
+            SKIP_BITS(re, gb, entry & 15);                              \
+        } else {                                                        \
+            DECODE_CODEWORD(val, to_cb[idx]);                           \
+            UPDATE_CACHE(re, gb);                                       \
+        }                                                               \
+    } while (0)
 
 static av_always_inline int decode_ac_coeffs(AVCodecContext *avctx, GetBitContext *gb,
                                              int16_t *out, int blocks_per_slice)
@@ -326,7 +420,6 @@ static av_always_inline int decode_ac_coeffs(AVCodecContext *avctx, GetBitContex
     int log2_block_count = av_log2(blocks_per_slice);
 
     OPEN_READER(re, gb);
-    UPDATE_CACHE(re, gb);                                           \
     run   = 4;
     level = 2;
 
@@ -334,18 +427,19 @@ static av_always_inline int decode_ac_coeffs(AVCodecContext *avctx, GetBitContex
     block_mask = blocks_per_slice - 1;
 
     for (pos = block_mask;;) {
+        UPDATE_CACHE(re, gb);
         bits_left = gb->size_in_bits - re_index;
         if (!bits_left || (bits_left < 32 && !SHOW_UBITS(re, gb, bits_left)))
             break;
 
-        DECODE_CODEWORD(run, run_to_cb[FFMIN(run,  15)]);
+        DECODE_AC_CODEWORD(run, FFMIN(run, 15), run_to_cb, run_to_lut);
         pos += run + 1;
         if (pos >= max_coeffs) {
             av_log(avctx, AV_LOG_ERROR, "ac tex damaged %d, %d\n", pos, max_coeffs);
             return AVERROR_INVALIDDATA;
         }
 
-        DECODE_CODEWORD(level, lev_to_cb[FFMIN(level, 9)]);
+        DECODE_AC_CODEWORD(level, FFMIN(level, 9), lev_to_cb, lev_to_lut);
         level += 1;
 
         i = pos >> log2_block_count;
@@ -628,6 +722,7 @@ static int decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
                         AVPacket *avpkt)
 {
     ProresContext *ctx = avctx->priv_data;
+    ThreadFrame tframe = { .f = data };
     AVFrame *frame = data;
     const uint8_t *buf = avpkt->data;
     int buf_size = avpkt->size;
@@ -653,7 +748,7 @@ static int decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
     buf += frame_hdr_size;
     buf_size -= frame_hdr_size;
 
-    if ((ret = ff_get_buffer(avctx, frame, 0)) < 0)
+    if ((ret = ff_thread_get_buffer(avctx, &tframe, 0)) < 0)
         return ret;
 
  decode_picture:
@@ -699,5 +794,7 @@ AVCodec ff_prores_decoder = {
     .init           = decode_init,
     .close          = decode_close,
     .decode         = decode_frame,
-    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_SLICE_THREADS,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS,
+    .init_thread_copy = ONLY_IF_THREADS_ENABLED(decode_init_thread_copy),
 };
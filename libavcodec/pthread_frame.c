@@ -587,8 +587,10 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
             av_freep(&p->avctx->slice_offset);
         }
 
-        if (p->avctx)
+        if (p->avctx) {
+            av_buffer_pool_uninit(&p->avctx->internal->mvs_pool);
             av_freep(&p->avctx->internal);
+        }
         av_freep(&p->avctx);
     }
 
@@ -38,6 +38,7 @@
 #include "libavutil/internal.h"
 #include "libavutil/mathematics.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/name_index.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/samplefmt.h"
@@ -145,6 +146,10 @@ void av_fast_padded_mallocz(void *ptr, unsigned int *size, size_t min_size)
 static AVCodec *first_avcodec = NULL;
 static AVCodec **last_avcodec = &first_avcodec;
 
+/* registered codecs by name and by id */
+FF_NAME_INDEX(codec_name_index, 2048);
+FF_NAME_INDEX(codec_id_index,   2048);
+
 AVCodec *av_codec_next(const AVCodec *c)
 {
     if (c)
@@ -186,6 +191,10 @@ av_cold void avcodec_register(AVCodec *codec)
         p = &(*p)->next;
     last_avcodec = &codec->next;
 
+    ff_name_index_add(&codec_name_index,
+                      ff_name_index_hash(codec->name, strlen(codec->name)), codec);
+    ff_name_index_add(&codec_id_index, ff_name_index_hash_int(codec->id), codec);
+
     if (codec->init_static_data)
         codec->init_static_data(codec);
 }
@@ -2978,6 +2987,7 @@ av_cold int avcodec_close(AVCodecContext *avctx)
         av_frame_free(&avctx->internal->to_free);
         av_frame_free(&avctx->internal->buffer_frame);
         av_packet_free(&avctx->internal->buffer_pkt);
+        av_buffer_pool_uninit(&avctx->internal->mvs_pool);
         for (i = 0; i < FF_ARRAY_ELEMS(pool->pools); i++)
             av_buffer_pool_uninit(&pool->pools[i]);
         av_freep(&avctx->internal->pool);
@@ -3026,8 +3036,24 @@ static enum AVCodecID remap_deprecated_codec_id(enum AVCodecID id)
 static AVCodec *find_encdec(enum AVCodecID id, int encoder)
 {
     AVCodec *p, *experimental = NULL;
-    p = first_avcodec;
     id= remap_deprecated_codec_id(id);
+
+    if (!codec_id_index.overflow) {
+        unsigned hash = ff_name_index_hash_int(id), i;
+
+        for (i = 0; (p = ff_name_index_get(&codec_id_index, hash, i)); i++) {
+            if ((encoder ? av_codec_is_encoder(p) : av_codec_is_decoder(p)) &&
+                p->id == id) {
+                if (p->capabilities & AV_CODEC_CAP_EXPERIMENTAL && !experimental) {
+                    experimental = p;
+                } else
+                    return p;
+            }
+        }
+        return experimental;
+    }
+
+    p = first_avcodec;
     while (p) {
         if ((encoder ? av_codec_is_encoder(p) : av_codec_is_decoder(p)) &&
             p->id == id) {
@@ -3046,11 +3072,25 @@ AVCodec *avcodec_find_encoder(enum AVCodecID id)
     return find_encdec(id, 1);
 }
 
+static AVCodec *find_encdec_by_name(const char *name, int encoder)
+{
+    unsigned hash = ff_name_index_hash(name, strlen(name)), i;
+    AVCodec *p;
+
+    for (i = 0; (p = ff_name_index_get(&codec_name_index, hash, i)); i++)
+        if ((encoder ? av_codec_is_encoder(p) : av_codec_is_decoder(p)) &&
+            !strcmp(name, p->name))
+            return p;
+    return NULL;
+}
+
 AVCodec *avcodec_find_encoder_by_name(const char *name)
 {
     AVCodec *p;
     if (!name)
         return NULL;
+    if (!codec_name_index.overflow)
+        return find_encdec_by_name(name, 1);
     p = first_avcodec;
     while (p) {
         if (av_codec_is_encoder(p) && strcmp(name, p->name) == 0)
@@ -3070,6 +3110,8 @@ AVCodec *avcodec_find_decoder_by_name(const char *name)
     AVCodec *p;
     if (!name)
         return NULL;
+    if (!codec_name_index.overflow)
+        return find_encdec_by_name(name, 0);
     p = first_avcodec;
     while (p) {
         if (av_codec_is_decoder(p) && strcmp(name, p->name) == 0)
@@ -21,7 +21,8 @@
 
 /**
  * @file
- * Simple wrapper to store an AVFrame and forward it as AVPacket.
+ * Simple wrapper to store an AVFrame and forward it as AVPacket, and to
+ * unwrap it again on the decoding side.
  */
 
 #include "avcodec.h"
@@ -43,19 +44,33 @@ static int wrapped_avframe_encode(AVCodecContext *avctx, AVPacket *pkt,
                      const AVFrame *frame, int *got_packet)
 {
     AVFrame *wrapped = av_frame_clone(frame);
+    int size = sizeof(*wrapped) + AV_INPUT_BUFFER_PADDING_SIZE;
+    uint8_t *data;
 
     if (!wrapped)
         return AVERROR(ENOMEM);
 
-    pkt->buf = av_buffer_create((uint8_t *)wrapped, sizeof(*wrapped),
+    /* with the padding the buffer is not reallocated, which would copy the
+     * frame struct and free the original along with its references */
+    data = av_mallocz(size);
+    if (!data) {
+        av_frame_free(&wrapped);
+        return AVERROR(ENOMEM);
+    }
+
+    pkt->buf = av_buffer_create(data, size,
                                 wrapped_avframe_release_buffer, NULL,
                                 AV_BUFFER_FLAG_READONLY);
     if (!pkt->buf) {
         av_frame_free(&wrapped);
+        av_freep(&data);
         return AVERROR(ENOMEM);
     }
 
-    pkt->data = (uint8_t *)wrapped;
+    av_frame_move_ref((AVFrame *)data, wrapped);
+    av_frame_free(&wrapped);
+
+    pkt->data = data;
     pkt->size = sizeof(*wrapped);
 
     pkt->flags |= AV_PKT_FLAG_KEY;
@@ -63,6 +78,32 @@ static int wrapped_avframe_encode(AVCodecContext *avctx, AVPacket *pkt,
     return 0;
 }
 
+static int wrapped_avframe_decode(AVCodecContext *avctx, void *data,
+                                  int *got_frame, AVPacket *pkt)
+{
+    AVFrame *frame = data;
+    int ret;
+
+    /* the packet holds pointers, never follow them for arbitrary input */
+    if (!(pkt->flags & AV_PKT_FLAG_TRUSTED)) {
+        av_log(avctx, AV_LOG_ERROR, "Wrapped AVFrame from an untrusted source\n");
+        return AVERROR(EPERM);
+    }
+    if (pkt->size < sizeof(AVFrame))
+        return AVERROR_INVALIDDATA;
+
+    ret = av_frame_ref(frame, (AVFrame *)pkt->data);
+    if (ret < 0)
+        return ret;
+
+    frame->pkt_pts = pkt->pts;
+    av_frame_set_pkt_duration(frame, pkt->duration);
+
+    *got_frame = 1;
+    return pkt->size;
+}
+
+#if CONFIG_WRAPPED_AVFRAME_ENCODER
 AVCodec ff_wrapped_avframe_encoder = {
     .name           = "wrapped_avframe",
     .long_name      = NULL_IF_CONFIG_SMALL("AVFrame to AVPacket passthrough"),
@@ -71,3 +112,15 @@ AVCodec ff_wrapped_avframe_encoder = {
     .encode2        = wrapped_avframe_encode,
     .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
 };
+#endif
+
+#if CONFIG_WRAPPED_AVFRAME_DECODER
+AVCodec ff_wrapped_avframe_decoder = {
+    .name           = "wrapped_avframe",
+    .long_name      = NULL_IF_CONFIG_SMALL("AVPacket to AVFrame passthrough"),
+    .type           = AVMEDIA_TYPE_VIDEO,
+    .id             = AV_CODEC_ID_WRAPPED_AVFRAME,
+    .decode         = wrapped_avframe_decode,
+    .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
+};
+#endif
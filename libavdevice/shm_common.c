@@ -0,0 +1,241 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libavutil/atomic.h"
+#include "libavutil/avutil.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/internal.h"
+#include "libavutil/time.h"
+
+#include "shm_common.h"
+
+static int check_interrupt(AVFormatContext *s)
+{
+    AVIOInterruptCB *cb = &s->interrupt_callback;
+
+    return cb->callback && cb->callback(cb->opaque);
+}
+
+int ff_shm_frame_layout(enum AVPixelFormat format, int width, int height,
+                        int linesize[4], uint64_t offset[4])
+{
+    uint8_t *data[4];
+    int i, ret;
+
+    ret = av_image_fill_linesizes(linesize, format, width);
+    if (ret < 0)
+        return ret;
+    for (i = 0; i < 4; i++)
+        linesize[i] = FFALIGN(linesize[i], SHM_ALIGN);
+
+    /* with a NULL base the pointers are the plane offsets, the linesizes
+     * keep them aligned */
+    ret = av_image_fill_pointers(data, format, height, NULL, linesize);
+    if (ret < 0)
+        return ret;
+    for (i = 0; i < 4; i++)
+        offset[i] = (uintptr_t)data[i];
+
+    return ret;
+}
+
+int ff_shm_ring_create(AVFormatContext *s, ShmRing *ring, const char *name,
+                       int nb_slots, size_t slot_size)
+{
+    pthread_mutexattr_t mutex_attr;
+    pthread_condattr_t cond_attr;
+    ShmRingHeader *hdr;
+    size_t header_size = FFALIGN(sizeof(*hdr), 4096);
+    int fd, ret;
+
+    slot_size = FFALIGN(slot_size, SHM_ALIGN);
+    if (nb_slots > SHM_RING_MAX_SLOTS ||
+        slot_size > (SIZE_MAX - header_size) / nb_slots)
+        return AVERROR(EINVAL);
+    ring->map_size = header_size + nb_slots * slot_size;
+
+    /* a stale object of a writer which did not exit cleanly is replaced */
+    shm_unlink(name);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        ret = AVERROR(errno);
+        av_log(s, AV_LOG_ERROR, "Could not create shared memory '%s': %s\n",
+               name, av_err2str(ret));
+        return ret;
+    }
+    if (ftruncate(fd, ring->map_size) < 0) {
+        ret = AVERROR(errno);
+        av_log(s, AV_LOG_ERROR, "Could not resize shared memory to %"SIZE_SPECIFIER" bytes: %s\n",
+               ring->map_size, av_err2str(ret));
+        goto fail;
+    }
+    ring->map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ring->map == MAP_FAILED) {
+        ret = AVERROR(errno);
+        av_log(s, AV_LOG_ERROR, "Could not map shared memory: %s\n", av_err2str(ret));
+        goto fail;
+    }
+    close(fd);
+
+    ring->nb_slots    = nb_slots;
+    ring->header_size = header_size;
+    ring->slot_size   = slot_size;
+
+    hdr = ring->hdr = (ShmRingHeader *)ring->map;
+    hdr->version        = SHM_RING_VERSION;
+    hdr->avutil_version = LIBAVUTIL_VERSION_MAJOR;
+    hdr->nb_slots       = nb_slots;
+    hdr->header_size    = header_size;
+    hdr->slot_size      = slot_size;
+
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_condattr_init(&cond_attr);
+    if (pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED) ||
+        pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED)) {
+        av_log(s, AV_LOG_ERROR, "Process shared locks are not supported\n");
+        ret = AVERROR(ENOSYS);
+    } else {
+        pthread_mutex_init(&hdr->lock, &mutex_attr);
+        pthread_cond_init(&hdr->cond, &cond_attr);
+        ret = 0;
+    }
+    pthread_mutexattr_destroy(&mutex_attr);
+    pthread_condattr_destroy(&cond_attr);
+    if (ret < 0) {
+        ff_shm_ring_unmap(ring);
+        shm_unlink(name);
+    }
+    return ret;
+
+fail:
+    close(fd);
+    shm_unlink(name);
+    return ret;
+}
+
+void ff_shm_ring_publish(ShmRing *ring)
+{
+    avpriv_atomic_int_set((volatile int *)&ring->hdr->magic, SHM_RING_MAGIC);
+}
+
+int ff_shm_ring_open(AVFormatContext *s, ShmRing *ring, const char *name)
+{
+    ShmRingHeader *hdr;
+    struct stat st;
+    uint64_t header_size, slot_size;
+    unsigned nb_slots;
+    int fd, ret;
+
+    /* the writer creates and initializes the object, wait for both */
+    while ((fd = shm_open(name, O_RDWR, 0)) < 0) {
+        ret = AVERROR(errno);
+        if (ret != AVERROR(ENOENT)) {
+            av_log(s, AV_LOG_ERROR, "Could not open shared memory '%s': %s\n",
+                   name, av_err2str(ret));
+            return ret;
+        }
+        if (check_interrupt(s))
+            return AVERROR_EXIT;
+        av_usleep(10000);
+    }
+
+    for (;;) {
+        if (fstat(fd, &st) < 0) {
+            ret = AVERROR(errno);
+            goto fail;
+        }
+        if (st.st_size >= sizeof(*hdr))
+            break;
+        if (check_interrupt(s)) {
+            ret = AVERROR_EXIT;
+            goto fail;
+        }
+        av_usleep(10000);
+    }
+
+    ring->map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ring->map == MAP_FAILED) {
+        ret = AVERROR(errno);
+        goto fail;
+    }
+    ring->map_size = st.st_size;
+    close(fd);
+
+    hdr = ring->hdr = (ShmRingHeader *)ring->map;
+    while (avpriv_atomic_int_get((volatile int *)&hdr->magic) != SHM_RING_MAGIC) {
+        if (check_interrupt(s)) {
+            ff_shm_ring_unmap(ring);
+            return AVERROR_EXIT;
+        }
+        av_usleep(10000);
+    }
+
+    /* the header is written by another process, read the layout once and
+     * check that every slot lies within the mapping */
+    nb_slots    = hdr->nb_slots;
+    header_size = hdr->header_size;
+    slot_size   = hdr->slot_size;
+    if (hdr->version != SHM_RING_VERSION ||
+        hdr->avutil_version != LIBAVUTIL_VERSION_MAJOR ||
+        !nb_slots || nb_slots > SHM_RING_MAX_SLOTS ||
+        header_size < sizeof(*hdr) || header_size > ring->map_size ||
+        slot_size < sizeof(ShmFrameHeader) ||
+        slot_size > (ring->map_size - header_size) / nb_slots) {
+        av_log(s, AV_LOG_ERROR, "Incompatible shared memory ring '%s'\n", name);
+        ff_shm_ring_unmap(ring);
+        return AVERROR(EINVAL);
+    }
+    ring->nb_slots    = nb_slots;
+    ring->header_size = header_size;
+    ring->slot_size   = slot_size;
+    return 0;
+
+fail:
+    av_log(s, AV_LOG_ERROR, "Could not map shared memory '%s': %s\n",
+           name, av_err2str(ret));
+    close(fd);
+    return ret;
+}
+
+void ff_shm_ring_unmap(ShmRing *ring)
+{
+    if (ring->hdr)
+        munmap(ring->map, ring->map_size);
+    ring->hdr = NULL;
+    ring->map = NULL;
+}
+
+int ff_shm_ring_wait(AVFormatContext *s, ShmRing *ring)
+{
+    /* the peer may be gone without signaling, so wake up regularly to
+     * check the interrupt callback */
+    int64_t t = av_gettime() + 100000;
+    struct timespec ts = { .tv_sec  = t / 1000000,
+                           .tv_nsec = t % 1000000 * 1000 };
+
+    pthread_cond_timedwait(&ring->hdr->cond, &ring->hdr->lock, &ts);
+
+    return check_interrupt(s) ? AVERROR_EXIT : 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVDEVICE_SHM_COMMON_H
+#define AVDEVICE_SHM_COMMON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "libavformat/avformat.h"
+
+/*
+ * Layout of the shared memory object: a ShmRingHeader, then nb_slots slots
+ * of slot_size bytes starting at header_size. A slot starts with a
+ * ShmFrameHeader, followed by the side data, the packed frame metadata and
+ * the planes of the frame at 64 byte aligned offsets.
+ *
+ * The ring state (nb_written, nb_read, slot_state) is only accessed with the
+ * process shared lock held. The writer fills slot nb_written % nb_slots once
+ * it is free, the reader hands out slot nb_read % nb_slots without copying
+ * and frees it when the last reference to the frame is gone.
+ */
+
+#define SHM_RING_MAGIC      MKBETAG('F', 'S', 'H', 'M')
+#define SHM_RING_VERSION    1
+#define SHM_RING_MAX_SLOTS  64
+#define SHM_ALIGN           64
+
+enum ShmSlotState {
+    SHM_SLOT_FREE,
+    SHM_SLOT_FILLED,
+    SHM_SLOT_READING,
+};
+
+typedef struct ShmRingHeader {
+    int32_t  magic;             ///< set last by the writer, once the header is initialized
+    uint32_t version;           ///< SHM_RING_VERSION
+    uint32_t avutil_version;    ///< major version of the writer's libavutil, the enums depend on it
+    uint32_t nb_slots;
+    uint64_t header_size;       ///< offset of the first slot
+    uint64_t slot_size;
+
+    /* stream parameters */
+    int32_t width, height, format;
+    int32_t time_base_num, time_base_den;
+    int32_t frame_rate_num, frame_rate_den;
+
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint64_t nb_written;
+    uint64_t nb_read;
+    int32_t  eof;               ///< no more frames will be written
+    int32_t  closed;            ///< the reader is gone
+    int32_t  slot_state[SHM_RING_MAX_SLOTS];
+} ShmRingHeader;
+
+typedef struct ShmFrameHeader {
+    int64_t  pts;
+    int64_t  duration;
+    int32_t  format, width, height;
+    uint64_t data_offset;       ///< offset of the planes from the start of the slot, laid out by ff_shm_frame_layout()
+    int32_t  key_frame, pict_type;
+    int32_t  interlaced_frame, top_field_first, repeat_pict;
+    int32_t  sample_aspect_ratio_num, sample_aspect_ratio_den;
+    int32_t  color_range, color_primaries, color_trc, colorspace, chroma_location;
+    uint32_t nb_side_data;      ///< number of ShmSideData entries following this header
+    uint32_t metadata_size;     ///< size of the packed metadata following the side data
+} ShmFrameHeader;
+
+/* followed by size bytes of data, padded to 8 bytes */
+typedef struct ShmSideData {
+    int32_t  type;
+    uint32_t size;
+} ShmSideData;
+
+typedef struct ShmRing {
+    ShmRingHeader *hdr;
+    uint8_t *map;
+    size_t map_size;
+    /* validated copies of the layout, the other process can change the
+     * shared header at any time */
+    unsigned nb_slots;
+    size_t header_size;
+    size_t slot_size;
+} ShmRing;
+
+/**
+ * Create the shared memory object name for writing and initialize the ring,
+ * the stream parameters in the header are left to the caller.
+ */
+int ff_shm_ring_create(AVFormatContext *s, ShmRing *ring, const char *name,
+                       int nb_slots, size_t slot_size);
+
+/**
+ * Make the ring created by ff_shm_ring_create() visible to the reader, after
+ * the stream parameters are set.
+ */
+void ff_shm_ring_publish(ShmRing *ring);
+
+/**
+ * Open the ring created by a writer, waiting for it to appear.
+ */
+int ff_shm_ring_open(AVFormatContext *s, ShmRing *ring, const char *name);
+
+void ff_shm_ring_unmap(ShmRing *ring);
+
+/**
+ * Wait for a change of the ring state, must be called with the lock held.
+ *
+ * @return 0 or AVERROR_EXIT if the interrupt callback of s requested to abort
+ */
+int ff_shm_ring_wait(AVFormatContext *s, ShmRing *ring);
+
+static inline uint8_t *ff_shm_ring_slot(const ShmRing *ring, uint64_t n)
+{
+    return ring->map + ring->header_size + (n % ring->nb_slots) * ring->slot_size;
+}
+
+/**
+ * Compute the linesizes and the plane offsets relative to the first plane
+ * of a frame stored in a slot. The offsets of unused planes are 0.
+ *
+ * @return the size of the planes or a negative error code
+ */
+int ff_shm_frame_layout(enum AVPixelFormat format, int width, int height,
+                        int linesize[4], uint64_t offset[4]);
+
+#endif /* AVDEVICE_SHM_COMMON_H */
@@ -0,0 +1,337 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Shared memory input device, reads the frames written by the shm output
+ * device of another process. The frames reference the shared memory
+ * directly and are passed on as wrapped_avframe packets.
+ */
+
+#include <string.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "libavformat/internal.h"
+#include "avdevice.h"
+#include "shm_common.h"
+
+typedef struct ShmReadContext {
+    AVClass *class;
+    AVBufferRef *ring_buf;  ///< ShmRing, unmapped when the last frame is gone
+} ShmReadContext;
+
+typedef struct ShmSlotRef {
+    AVBufferRef *ring_buf;
+    uint64_t n;
+} ShmSlotRef;
+
+static void ring_free(void *opaque, uint8_t *data)
+{
+    ShmRing *ring = (ShmRing *)data;
+
+    ff_shm_ring_unmap(ring);
+    av_free(ring);
+}
+
+static void release_slot(ShmRing *ring, uint64_t n)
+{
+    ShmRingHeader *hdr = ring->hdr;
+
+    pthread_mutex_lock(&hdr->lock);
+    hdr->slot_state[n % ring->nb_slots] = SHM_SLOT_FREE;
+    pthread_cond_broadcast(&hdr->cond);
+    pthread_mutex_unlock(&hdr->lock);
+}
+
+static void slot_free(void *opaque, uint8_t *data)
+{
+    ShmSlotRef *ref = opaque;
+
+    release_slot((ShmRing *)ref->ring_buf->data, ref->n);
+    av_buffer_unref(&ref->ring_buf);
+    av_free(ref);
+}
+
+static void wrapped_frame_free(void *opaque, uint8_t *data)
+{
+    AVFrame *frame = (AVFrame *)data;
+
+    av_frame_free(&frame);
+}
+
+static av_cold int shm_read_header(AVFormatContext *s)
+{
+    ShmReadContext *c = s->priv_data;
+    ShmRingHeader *hdr;
+    ShmRing *ring;
+    AVStream *st;
+    int ret;
+
+    ring = av_mallocz(sizeof(*ring));
+    if (!ring)
+        return AVERROR(ENOMEM);
+    ret = ff_shm_ring_open(s, ring, s->filename);
+    if (ret < 0) {
+        av_free(ring);
+        return ret;
+    }
+    c->ring_buf = av_buffer_create((uint8_t *)ring, sizeof(*ring), ring_free, NULL, 0);
+    if (!c->ring_buf) {
+        ring_free(NULL, (uint8_t *)ring);
+        return AVERROR(ENOMEM);
+    }
+    hdr = ring->hdr;
+
+    if (hdr->time_base_num <= 0 || hdr->time_base_den <= 0) {
+        av_log(s, AV_LOG_ERROR, "Invalid time base %d/%d\n",
+               hdr->time_base_num, hdr->time_base_den);
+        ret = AVERROR(EINVAL);
+        goto fail;
+    }
+
+    st = avformat_new_stream(s, NULL);
+    if (!st) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    st->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+    st->codecpar->codec_id   = AV_CODEC_ID_WRAPPED_AVFRAME;
+    st->codecpar->width      = hdr->width;
+    st->codecpar->height     = hdr->height;
+    st->codecpar->format     = hdr->format;
+    avpriv_set_pts_info(st, 64, hdr->time_base_num, hdr->time_base_den);
+    if (hdr->frame_rate_num > 0 && hdr->frame_rate_den > 0)
+        st->avg_frame_rate = st->r_frame_rate =
+            (AVRational){ hdr->frame_rate_num, hdr->frame_rate_den };
+
+    return 0;
+
+fail:
+    /* read_close() is not called when the header fails */
+    av_buffer_unref(&c->ring_buf);
+    return ret;
+}
+
+/* the slot is written by another process, check everything */
+static int unpack_frame(AVFormatContext *s, AVFrame *frame, uint8_t *slot,
+                        uint64_t slot_size)
+{
+    const ShmFrameHeader fh = *(const ShmFrameHeader *)slot;
+    const uint8_t *p = slot + sizeof(fh), *end;
+    uint64_t offset[4];
+    int linesize[4];
+    int i, size, ret;
+
+    if (!av_pix_fmt_desc_get(fh.format) ||
+        av_image_check_size(fh.width, fh.height, 0, s) < 0)
+        goto invalid;
+    size = ff_shm_frame_layout(fh.format, fh.width, fh.height,
+                               linesize, offset);
+    if (size < 0 || fh.data_offset < sizeof(fh) ||
+        fh.data_offset > slot_size || slot_size - fh.data_offset < size)
+        goto invalid;
+    end = slot + fh.data_offset;
+
+    for (i = 0; i < fh.nb_side_data; i++) {
+        ShmSideData ssd;
+        AVFrameSideData *sd;
+
+        if (end - p < sizeof(ssd))
+            goto invalid;
+        memcpy(&ssd, p, sizeof(ssd));
+        p += sizeof(ssd);
+        if (end - p < ssd.size)
+            goto invalid;
+        sd = av_frame_new_side_data(frame, ssd.type, ssd.size);
+        if (!sd)
+            return AVERROR(ENOMEM);
+        memcpy(sd->data, p, ssd.size);
+        p += FFMIN(FFALIGN((uint64_t)ssd.size, 8), end - p);
+    }
+
+    if (fh.metadata_size > end - p)
+        goto invalid;
+    end = p + fh.metadata_size;
+    while (p < end) {
+        const uint8_t *key = p, *value;
+
+        if (!(value = memchr(key, 0, end - key)) || ++value == end ||
+            !(p = memchr(value, 0, end - value)))
+            goto invalid;
+        p++;
+        ret = av_dict_set(&frame->metadata, (const char *)key,
+                          (const char *)value, 0);
+        if (ret < 0)
+            return ret;
+    }
+
+    for (i = 0; i < 4; i++) {
+        if (i && !offset[i])
+            break;
+        frame->data[i]     = slot + fh.data_offset + offset[i];
+        frame->linesize[i] = linesize[i];
+    }
+
+    frame->format                  = fh.format;
+    frame->width                   = fh.width;
+    frame->height                  = fh.height;
+    frame->pts                     = fh.pts;
+    frame->key_frame               = fh.key_frame;
+    frame->pict_type               = fh.pict_type;
+    frame->interlaced_frame        = fh.interlaced_frame;
+    frame->top_field_first         = fh.top_field_first;
+    frame->repeat_pict             = fh.repeat_pict;
+    frame->sample_aspect_ratio     = (AVRational){ fh.sample_aspect_ratio_num,
+                                                   fh.sample_aspect_ratio_den };
+    frame->color_range             = fh.color_range;
+    frame->color_primaries         = fh.color_primaries;
+    frame->color_trc               = fh.color_trc;
+    frame->colorspace              = fh.colorspace;
+    frame->chroma_location         = fh.chroma_location;
+    av_frame_set_pkt_duration(frame, fh.duration);
+
+    return 0;
+
+invalid:
+    av_log(s, AV_LOG_ERROR, "Invalid frame in the shared memory ring\n");
+    return AVERROR_INVALIDDATA;
+}
+
+static int shm_read_packet(AVFormatContext *s, AVPacket *pkt)
+{
+    ShmReadContext *c = s->priv_data;
+    ShmRing *ring = (ShmRing *)c->ring_buf->data;
+    ShmRingHeader *hdr = ring->hdr;
+    ShmSlotRef *ref;
+    AVFrame *frame;
+    uint8_t *slot, *wrapped;
+    uint64_t n;
+    int ret = 0;
+
+    pthread_mutex_lock(&hdr->lock);
+    while (hdr->nb_read == hdr->nb_written) {
+        if (hdr->eof)
+            ret = AVERROR_EOF;
+        else if (s->flags & AVFMT_FLAG_NONBLOCK)
+            ret = AVERROR(EAGAIN);
+        else
+            ret = ff_shm_ring_wait(s, ring);
+        if (ret < 0)
+            break;
+    }
+    if (ret >= 0) {
+        n = hdr->nb_read++;
+        hdr->slot_state[n % ring->nb_slots] = SHM_SLOT_READING;
+        pthread_cond_broadcast(&hdr->cond);
+    }
+    pthread_mutex_unlock(&hdr->lock);
+    if (ret < 0)
+        return ret;
+
+    slot  = ff_shm_ring_slot(ring, n);
+    frame = av_frame_alloc();
+    ref   = av_mallocz(sizeof(*ref));
+    if (!frame || !ref || !(ref->ring_buf = av_buffer_ref(c->ring_buf))) {
+        release_slot(ring, n);
+        av_frame_free(&frame);
+        av_free(ref);
+        return AVERROR(ENOMEM);
+    }
+    ref->n = n;
+
+    /* the slot is freed when the last reference to the frame is gone */
+    frame->buf[0] = av_buffer_create(slot, ring->slot_size, slot_free, ref, 0);
+    if (!frame->buf[0]) {
+        slot_free(ref, NULL);
+        av_frame_free(&frame);
+        return AVERROR(ENOMEM);
+    }
+
+    ret = unpack_frame(s, frame, slot, ring->slot_size);
+    if (ret < 0) {
+        av_frame_free(&frame);
+        return ret;
+    }
+
+    /* padded like the packets of the wrapped_avframe encoder */
+    wrapped = av_mallocz(sizeof(*frame) + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!wrapped) {
+        av_frame_free(&frame);
+        return AVERROR(ENOMEM);
+    }
+    pkt->buf = av_buffer_create(wrapped, sizeof(*frame) + AV_INPUT_BUFFER_PADDING_SIZE,
+                                wrapped_frame_free, NULL, 0);
+    if (!pkt->buf) {
+        av_frame_free(&frame);
+        av_free(wrapped);
+        return AVERROR(ENOMEM);
+    }
+    av_frame_move_ref((AVFrame *)wrapped, frame);
+    av_frame_free(&frame);
+    frame = (AVFrame *)wrapped;
+
+    pkt->data         = wrapped;
+    pkt->size         = sizeof(*frame);
+    pkt->pts          =
+    pkt->dts          = frame->pts;
+    pkt->duration     = av_frame_get_pkt_duration(frame);
+    pkt->stream_index = 0;
+    pkt->flags       |= AV_PKT_FLAG_KEY | AV_PKT_FLAG_TRUSTED;
+
+    return 0;
+}
+
+static av_cold int shm_read_close(AVFormatContext *s)
+{
+    ShmReadContext *c = s->priv_data;
+
+    if (c->ring_buf) {
+        ShmRingHeader *hdr = ((ShmRing *)c->ring_buf->data)->hdr;
+
+        /* let a waiting writer know that nobody reads anymore, frames still
+         * referenced keep the memory mapped */
+        pthread_mutex_lock(&hdr->lock);
+        hdr->closed = 1;
+        pthread_cond_broadcast(&hdr->cond);
+        pthread_mutex_unlock(&hdr->lock);
+    }
+    av_buffer_unref(&c->ring_buf);
+
+    return 0;
+}
+
+static const AVClass shm_class = {
+    .class_name = "shm indev",
+    .item_name  = av_default_item_name,
+    .version    = LIBAVUTIL_VERSION_INT,
+    .category   = AV_CLASS_CATEGORY_DEVICE_VIDEO_INPUT,
+};
+
+AVInputFormat ff_shm_demuxer = {
+    .name           = "shm",
+    .long_name      = NULL_IF_CONFIG_SMALL("Shared memory frame transport"),
+    .priv_data_size = sizeof(ShmReadContext),
+    .read_header    = shm_read_header,
+    .read_packet    = shm_read_packet,
+    .read_close     = shm_read_close,
+    .flags          = AVFMT_NOFILE,
+    .priv_class     = &shm_class,
+};
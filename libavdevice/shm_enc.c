@@ -0,0 +1,265 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Shared memory output device, writes the frames into a ring in a POSIX
+ * shared memory object read by the shm input device of another process.
+ */
+
+#include <sys/mman.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "libavformat/internal.h"
+#include "avdevice.h"
+#include "shm_common.h"
+
+typedef struct ShmWriteContext {
+    AVClass *class;
+    int nb_slots;
+    int side_data_size;
+    ShmRing ring;
+} ShmWriteContext;
+
+static av_cold int shm_write_header(AVFormatContext *s)
+{
+    ShmWriteContext *c = s->priv_data;
+    AVStream *st = s->streams[0];
+    AVCodecParameters *par = st->codecpar;
+    ShmRingHeader *hdr;
+    AVRational frame_rate;
+    uint64_t offset[4];
+    int linesize[4];
+    int size, ret;
+
+    if (s->nb_streams != 1 || par->codec_type != AVMEDIA_TYPE_VIDEO ||
+        par->codec_id != AV_CODEC_ID_WRAPPED_AVFRAME) {
+        av_log(s, AV_LOG_ERROR, "Only a single wrapped_avframe stream is supported.\n");
+        return AVERROR(EINVAL);
+    }
+
+    size = ff_shm_frame_layout(par->format, par->width, par->height,
+                               linesize, offset);
+    if (size < 0) {
+        av_log(s, AV_LOG_ERROR, "Unsupported frame size %dx%d or pixel format.\n",
+               par->width, par->height);
+        return size;
+    }
+
+    ret = ff_shm_ring_create(s, &c->ring, s->filename, c->nb_slots,
+                             sizeof(ShmFrameHeader) + c->side_data_size +
+                             SHM_ALIGN + size);
+    if (ret < 0)
+        return ret;
+
+    frame_rate = st->avg_frame_rate.num ? st->avg_frame_rate : st->r_frame_rate;
+
+    hdr = c->ring.hdr;
+    hdr->width          = par->width;
+    hdr->height         = par->height;
+    hdr->format         = par->format;
+    hdr->time_base_num  = st->time_base.num;
+    hdr->time_base_den  = st->time_base.den;
+    hdr->frame_rate_num = frame_rate.num;
+    hdr->frame_rate_den = frame_rate.den;
+    ff_shm_ring_publish(&c->ring);
+
+    return 0;
+}
+
+static int write_frame(AVFormatContext *s, const AVFrame *frame,
+                       int64_t pts, int64_t duration)
+{
+    ShmWriteContext *c = s->priv_data;
+    ShmRingHeader *hdr = c->ring.hdr;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    AVDictionaryEntry *e = NULL;
+    ShmFrameHeader *fh;
+    uint8_t *slot, *end, *p, *metadata, *data[4];
+    uint64_t offset[4];
+    int linesize[4];
+    int i, size, ret = 0;
+
+    if (!desc || desc->flags & AV_PIX_FMT_FLAG_HWACCEL) {
+        av_log(s, AV_LOG_ERROR, "Hardware frames are not supported.\n");
+        return AVERROR(EINVAL);
+    }
+
+    /* only the writer changes nb_written, the reader frees the slots */
+    pthread_mutex_lock(&hdr->lock);
+    while (hdr->slot_state[hdr->nb_written % c->ring.nb_slots] != SHM_SLOT_FREE &&
+           !hdr->closed && ret >= 0)
+        ret = ff_shm_ring_wait(s, &c->ring);
+    if (ret >= 0 && hdr->closed)
+        ret = AVERROR(EPIPE);
+    pthread_mutex_unlock(&hdr->lock);
+    if (ret < 0)
+        return ret;
+
+    slot = ff_shm_ring_slot(&c->ring, hdr->nb_written);
+    end  = slot + c->ring.slot_size;
+    fh   = (ShmFrameHeader *)slot;
+    p    = slot + sizeof(*fh);
+
+    fh->nb_side_data = 0;
+    for (i = 0; i < frame->nb_side_data; i++) {
+        const AVFrameSideData *sd = frame->side_data[i];
+        ShmSideData *ssd = (ShmSideData *)p;
+
+        if (end - p < sizeof(*ssd) + FFALIGN(sd->size, 8))
+            goto too_large;
+        ssd->type = sd->type;
+        ssd->size = sd->size;
+        memcpy(p + sizeof(*ssd), sd->data, sd->size);
+        p += sizeof(*ssd) + FFALIGN(sd->size, 8);
+        fh->nb_side_data++;
+    }
+
+    metadata = p;
+    while ((e = av_dict_get(frame->metadata, "", e, AV_DICT_IGNORE_SUFFIX))) {
+        size_t key_size   = strlen(e->key)   + 1;
+        size_t value_size = strlen(e->value) + 1;
+
+        if (end - p < key_size + value_size)
+            goto too_large;
+        memcpy(p,            e->key,   key_size);
+        memcpy(p + key_size, e->value, value_size);
+        p += key_size + value_size;
+    }
+    fh->metadata_size = p - metadata;
+
+    size = ff_shm_frame_layout(frame->format, frame->width, frame->height,
+                               linesize, offset);
+    if (size < 0)
+        return size;
+    p = slot + FFALIGN(p - slot, SHM_ALIGN);
+    if (end - p < size)
+        goto too_large;
+
+    for (i = 0; i < 4; i++)
+        data[i] = !i || offset[i] ? p + offset[i] : NULL;
+    av_image_copy(data, linesize, (const uint8_t **)frame->data, frame->linesize,
+                  frame->format, frame->width, frame->height);
+
+    fh->data_offset             = p - slot;
+    fh->pts                     = pts;
+    fh->duration                = duration;
+    fh->format                  = frame->format;
+    fh->width                   = frame->width;
+    fh->height                  = frame->height;
+    fh->key_frame               = frame->key_frame;
+    fh->pict_type               = frame->pict_type;
+    fh->interlaced_frame        = frame->interlaced_frame;
+    fh->top_field_first         = frame->top_field_first;
+    fh->repeat_pict             = frame->repeat_pict;
+    fh->sample_aspect_ratio_num = frame->sample_aspect_ratio.num;
+    fh->sample_aspect_ratio_den = frame->sample_aspect_ratio.den;
+    fh->color_range             = frame->color_range;
+    fh->color_primaries         = frame->color_primaries;
+    fh->color_trc               = frame->color_trc;
+    fh->colorspace              = frame->colorspace;
+    fh->chroma_location         = frame->chroma_location;
+
+    pthread_mutex_lock(&hdr->lock);
+    hdr->slot_state[hdr->nb_written % c->ring.nb_slots] = SHM_SLOT_FILLED;
+    hdr->nb_written++;
+    pthread_cond_broadcast(&hdr->cond);
+    pthread_mutex_unlock(&hdr->lock);
+
+    return 0;
+
+too_large:
+    av_log(s, AV_LOG_ERROR, "Frame does not fit into a slot of %"SIZE_SPECIFIER" bytes, "
+           "try increasing side_data_size.\n", c->ring.slot_size);
+    return AVERROR(ENOSPC);
+}
+
+static int shm_write_packet(AVFormatContext *s, AVPacket *pkt)
+{
+    return write_frame(s, (const AVFrame *)pkt->data, pkt->pts, pkt->duration);
+}
+
+static int shm_write_uncoded_frame(AVFormatContext *s, int stream_index,
+                                   AVFrame **frame, unsigned flags)
+{
+    if ((flags & AV_WRITE_UNCODED_FRAME_QUERY))
+        return 0;
+    return write_frame(s, *frame, (*frame)->pts, av_frame_get_pkt_duration(*frame));
+}
+
+static int shm_write_trailer(AVFormatContext *s)
+{
+    ShmWriteContext *c = s->priv_data;
+    ShmRingHeader *hdr = c->ring.hdr;
+    int ret = 0;
+
+    /* keep the object linked until the reader has taken all frames, so a
+     * reader started late still gets them */
+    pthread_mutex_lock(&hdr->lock);
+    hdr->eof = 1;
+    pthread_cond_broadcast(&hdr->cond);
+    while (hdr->nb_read < hdr->nb_written && !hdr->closed && ret >= 0)
+        ret = ff_shm_ring_wait(s, &c->ring);
+    pthread_mutex_unlock(&hdr->lock);
+
+    return ret;
+}
+
+static void shm_deinit(AVFormatContext *s)
+{
+    ShmWriteContext *c = s->priv_data;
+
+    if (c->ring.hdr) {
+        shm_unlink(s->filename);
+        ff_shm_ring_unmap(&c->ring);
+    }
+}
+
+#define OFFSET(x) offsetof(ShmWriteContext, x)
+#define ENC AV_OPT_FLAG_ENCODING_PARAM
+static const AVOption options[] = {
+    { "nb_slots",       "set the number of frames in the ring",               OFFSET(nb_slots),       AV_OPT_TYPE_INT, { .i64 = 4 },     2, SHM_RING_MAX_SLOTS, ENC },
+    { "side_data_size", "set the size reserved for side data in every frame", OFFSET(side_data_size), AV_OPT_TYPE_INT, { .i64 = 65536 }, 0, INT_MAX / 2,        ENC },
+    { NULL },
+};
+
+static const AVClass shm_class = {
+    .class_name = "shm outdev",
+    .item_name  = av_default_item_name,
+    .option     = options,
+    .version    = LIBAVUTIL_VERSION_INT,
+    .category   = AV_CLASS_CATEGORY_DEVICE_VIDEO_OUTPUT,
+};
+
+AVOutputFormat ff_shm_muxer = {
+    .name           = "shm",
+    .long_name      = NULL_IF_CONFIG_SMALL("Shared memory frame transport"),
+    .priv_data_size = sizeof(ShmWriteContext),
+    .audio_codec    = AV_CODEC_ID_NONE,
+    .video_codec    = AV_CODEC_ID_WRAPPED_AVFRAME,
+    .write_header   = shm_write_header,
+    .write_packet   = shm_write_packet,
+    .write_uncoded_frame = shm_write_uncoded_frame,
+    .write_trailer  = shm_write_trailer,
+    .deinit         = shm_deinit,
+    .flags          = AVFMT_NOFILE | AVFMT_VARIABLE_FPS,
+    .priv_class     = &shm_class,
+};
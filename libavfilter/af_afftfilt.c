@@ -109,11 +109,11 @@ static int config_input(AVFilterLink *inlink)
     if (!s->fft_data)
         return AVERROR(ENOMEM);
 
-    for (ch = 0; ch < inlink->channels; ch++) {
-        s->fft_data[ch] = av_calloc(s->window_size, sizeof(**s->fft_data));
-        if (!s->fft_data[ch])
-            return AVERROR(ENOMEM);
-    }
+    s->fft_data[0] = av_calloc(inlink->channels * s->window_size, sizeof(**s->fft_data));
+    if (!s->fft_data[0])
+        return AVERROR(ENOMEM);
+    for (ch = 1; ch < inlink->channels; ch++)
+        s->fft_data[ch] = s->fft_data[0] + ch * s->window_size;
 
     s->real = av_calloc(inlink->channels, sizeof(*s->real));
     if (!s->real)
@@ -231,16 +231,14 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
         values[VAR_NBBINS]      = window_size / 2;
         values[VAR_CHANNELS]    = inlink->channels;
 
+        av_fft_calc_batch(s->fft, s->fft_data[0], window_size, inlink->channels);
+
         for (ch = 0; ch < inlink->channels; ch++) {
             FFTComplex *fft_data = s->fft_data[ch];
-            float *buf = (float *)s->buffer->extended_data[ch];
             int x;
 
             values[VAR_CHANNEL] = ch;
 
-            av_fft_permute(s->fft, fft_data);
-            av_fft_calc(s->fft, fft_data);
-
             for (n = 0; n < window_size / 2; n++) {
                 float fr, fi;
 
@@ -257,9 +255,12 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
                 fft_data[n].re =  fft_data[x].re;
                 fft_data[n].im = -fft_data[x].im;
             }
+        }
+
+        av_fft_calc_batch(s->ifft, s->fft_data[0], window_size, inlink->channels);
 
-            av_fft_permute(s->ifft, fft_data);
-            av_fft_calc(s->ifft, fft_data);
+        for (ch = 0; ch < inlink->channels; ch++) {
+            float *buf = (float *)s->buffer->extended_data[ch];
 
             start = s->start;
             end = s->end;
@@ -357,10 +358,8 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_fft_end(s->fft);
     av_fft_end(s->ifft);
 
-    for (i = 0; i < s->nb_exprs; i++) {
-        if (s->fft_data)
-            av_freep(&s->fft_data[i]);
-    }
+    if (s->fft_data)
+        av_freep(&s->fft_data[0]);
     av_freep(&s->fft_data);
 
     for (i = 0; i < s->nb_exprs; i++) {
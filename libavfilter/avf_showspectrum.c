@@ -226,10 +226,8 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     av_freep(&s->combine_buffer);
     av_fft_end(s->fft);
-    if (s->fft_data) {
-        for (i = 0; i < s->nb_display_channels; i++)
-            av_freep(&s->fft_data[i]);
-    }
+    if (s->fft_data)
+        av_freep(&s->fft_data[0]);
     av_freep(&s->fft_data);
     av_freep(&s->window_func_lut);
     if (s->magnitudes) {
@@ -328,8 +326,8 @@ static int config_output(AVFilterLink *outlink)
         /* FFT buffers: x2 for each (display) channel buffer.
          * Note: we use free and malloc instead of a realloc-like function to
          * make sure the buffer is aligned in memory for the FFT functions. */
-        for (i = 0; i < s->nb_display_channels; i++)
-            av_freep(&s->fft_data[i]);
+        if (s->fft_data)
+            av_freep(&s->fft_data[0]);
         av_freep(&s->fft_data);
         s->nb_display_channels = inlink->channels;
 
@@ -351,14 +349,16 @@ static int config_output(AVFilterLink *outlink)
                 return AVERROR(ENOMEM);
         }
 
+        /* all channels share one buffer so they can be transformed in a
+         * single batch */
         s->fft_data = av_calloc(s->nb_display_channels, sizeof(*s->fft_data));
         if (!s->fft_data)
             return AVERROR(ENOMEM);
-        for (i = 0; i < s->nb_display_channels; i++) {
-            s->fft_data[i] = av_calloc(s->win_size, sizeof(**s->fft_data));
-            if (!s->fft_data[i])
-                return AVERROR(ENOMEM);
-        }
+        s->fft_data[0] = av_calloc(s->nb_display_channels * s->win_size, sizeof(**s->fft_data));
+        if (!s->fft_data[0])
+            return AVERROR(ENOMEM);
+        for (i = 1; i < s->nb_display_channels; i++)
+            s->fft_data[i] = s->fft_data[0] + i * s->win_size;
 
         /* pre-calc windowing function */
         s->window_func_lut =
@@ -440,10 +440,7 @@ static void run_fft(ShowSpectrumContext *s, AVFrame *fin)
     }
 
     /* run FFT on each samples set */
-    for (ch = 0; ch < s->nb_display_channels; ch++) {
-        av_fft_permute(s->fft, s->fft_data[ch]);
-        av_fft_calc(s->fft, s->fft_data[ch]);
-    }
+    av_fft_calc_batch(s->fft, s->fft_data[0], s->win_size, s->nb_display_channels);
 }
 
 #define RE(y, ch) s->fft_data[ch][y].re
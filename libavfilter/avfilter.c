@@ -29,6 +29,7 @@
 #include "libavutil/hwcontext.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/internal.h"
+#include "libavutil/name_index.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/rational.h"
@@ -512,6 +513,7 @@ int avfilter_process_command(AVFilterContext *filter, const char *cmd, const cha
 
 static AVFilter *first_filter;
 static AVFilter **last_filter = &first_filter;
+FF_NAME_INDEX(filter_name_index, 1024);
 
 #if !FF_API_NOCONST_GET_NAME
 const
@@ -523,6 +525,15 @@ AVFilter *avfilter_get_by_name(const char *name)
     if (!name)
         return NULL;
 
+    if (!filter_name_index.overflow) {
+        unsigned hash = ff_name_index_hash(name, strlen(name)), i;
+
+        for (i = 0; (f = ff_name_index_get(&filter_name_index, hash, i)); i++)
+            if (!strcmp(f->name, name))
+                return (AVFilter *)f;
+        return NULL;
+    }
+
     while ((f = avfilter_next(f)))
         if (!strcmp(f->name, name))
             return (AVFilter *)f;
@@ -543,6 +554,9 @@ int avfilter_register(AVFilter *filter)
         f = &(*f)->next;
     last_filter = &filter->next;
 
+    ff_name_index_add(&filter_name_index,
+                      ff_name_index_hash(filter->name, strlen(filter->name)), filter);
+
     return 0;
 }
 
@@ -155,7 +155,7 @@ static int config_input(AVFilterLink *inlink)
 }
 
 #define SET_META(key, value) \
-    av_dict_set_int(metadata, key, value, 0)
+    av_dict_set_int(metadata, key, value, AV_DICT_STATIC_KEY)
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
 {
@@ -134,6 +134,12 @@ enum expansion_mode {
     EXP_STRFTIME,
 };
 
+/* Number of low code points whose glyphs are looked up in a flat table
+ * instead of the tree. */
+#define GLYPH_TABLE_SIZE 256
+
+struct Glyph;
+
 typedef struct DrawTextContext {
     const AVClass *class;
     int exp_mode;                   ///< expansion mode to use for the text
@@ -148,7 +154,12 @@ typedef struct DrawTextContext {
     AVBPrint expanded_fontcolor;    ///< used to contain the expanded fontcolor spec
     int ft_load_flags;              ///< flags used for loading fonts, see FT_LOAD_*
     FT_Vector *positions;           ///< positions for each element in the text
+    struct Glyph **text_glyphs;     ///< glyph for each element in the text
     size_t nb_positions;            ///< number of elements of positions array
+    char *layout_text;              ///< text the current positions were computed for
+    int layout_w, layout_h;         ///< text width and height of the current layout
+    int layout_ascent;              ///< max glyph ascent of the current layout
+    int layout_descent;             ///< max glyph descent of the current layout
     char *textfile;                 ///< file with text to be drawn
     int x;                          ///< x position to start drawing text
     int y;                          ///< y position to start drawing text
@@ -174,6 +185,7 @@ typedef struct DrawTextContext {
     FT_Face face;                   ///< freetype font face handle
     FT_Stroker stroker;             ///< freetype stroker handle
     struct AVTreeNode *glyphs;      ///< rendered glyphs, stored using the UTF-32 char code
+    struct Glyph *glyph_table[GLYPH_TABLE_SIZE]; ///< direct lookup of the low code points
     char *x_expr;                   ///< expression for x position
     char *y_expr;                   ///< expression for y position
     AVExpr *x_pexpr, *y_pexpr;      ///< parsed expressions for x and y
@@ -295,6 +307,16 @@ static int glyph_cmp(const void *key, const void *b)
     return diff > 0 ? 1 : diff < 0 ? -1 : 0;
 }
 
+static Glyph *find_glyph(DrawTextContext *s, uint32_t code)
+{
+    Glyph dummy = { 0 };
+
+    if (code < GLYPH_TABLE_SIZE)
+        return s->glyph_table[code];
+    dummy.code = code;
+    return av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+}
+
 /**
  * Load glyphs corresponding to the UTF-32 codepoint code.
  */
@@ -351,6 +373,8 @@ static int load_glyph(AVFilterContext *ctx, Glyph **glyph_ptr, uint32_t code)
         goto error;
     }
     av_tree_insert(&s->glyphs, glyph, glyph_cmp, &node);
+    if (code < GLYPH_TABLE_SIZE)
+        s->glyph_table[code] = glyph;
 
     if (glyph_ptr)
         *glyph_ptr = glyph;
@@ -709,12 +733,15 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_expr_free(s->y_pexpr);
     s->x_pexpr = s->y_pexpr = NULL;
     av_freep(&s->positions);
+    av_freep(&s->text_glyphs);
     s->nb_positions = 0;
+    av_freep(&s->layout_text);
 
 
     av_tree_enumerate(s->glyphs, NULL, NULL, glyph_enu_free);
     av_tree_destroy(s->glyphs);
     s->glyphs = NULL;
+    memset(s->glyph_table, 0, sizeof(s->glyph_table));
 
     FT_Done_Face(s->face);
     FT_Stroker_Done(s->stroker);
@@ -1083,15 +1110,13 @@ static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
 
     for (i = 0, p = text; *p; i++) {
         FT_Bitmap bitmap;
-        Glyph dummy = { 0 };
         GET_UTF8(code, *p++, continue;);
 
         /* skip new line chars, just go to new line */
         if (code == '\n' || code == '\r' || code == '\t')
             continue;
 
-        dummy.code = code;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+        glyph = s->text_glyphs[i];
 
         bitmap = borderw ? glyph->border_bitmap : glyph->bitmap;
 
@@ -1152,7 +1177,6 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
     int x_min = 32000, x_max = -32000;
     FT_Vector delta;
     Glyph *glyph = NULL, *prev_glyph = NULL;
-    Glyph dummy = { 0 };
 
     time_t now = time(0);
     struct tm ltime;
@@ -1196,6 +1220,9 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
         if (!(s->positions =
               av_realloc(s->positions, len*sizeof(*s->positions))))
             return AVERROR(ENOMEM);
+        if (!(s->text_glyphs =
+              av_realloc(s->text_glyphs, len*sizeof(*s->text_glyphs))))
+            return AVERROR(ENOMEM);
         s->nb_positions = len;
     }
 
@@ -1213,6 +1240,16 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
         ff_draw_color(&s->dc, &s->fontcolor, s->fontcolor.rgba);
     }
 
+    /* the layout only depends on the text, reuse it if it did not change */
+    if (s->layout_text && !strcmp(s->layout_text, text)) {
+        max_text_line_w = s->layout_w;
+        y               = s->layout_h - s->max_glyph_h;
+        y_max           = s->layout_ascent;
+        y_min           = s->layout_descent;
+        goto layout_done;
+    }
+    av_freep(&s->layout_text);
+
     x = 0;
     y = 0;
 
@@ -1221,13 +1258,13 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
         GET_UTF8(code, *p++, continue;);
 
         /* get glyph */
-        dummy.code = code;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+        glyph = find_glyph(s, code);
         if (!glyph) {
             ret = load_glyph(ctx, &glyph, code);
             if (ret < 0)
                 return ret;
         }
+        s->text_glyphs[i] = glyph;
 
         y_min = FFMIN(glyph->bbox.yMin, y_min);
         y_max = FFMAX(glyph->bbox.yMax, y_max);
@@ -1257,8 +1294,7 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
 
         /* get glyph */
         prev_glyph = glyph;
-        dummy.code = code;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+        glyph = s->text_glyphs[i];
 
         /* kerning */
         if (s->use_kerning && prev_glyph && glyph->code) {
@@ -1276,6 +1312,13 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
 
     max_text_line_w = FFMAX(x, max_text_line_w);
 
+    s->layout_w       = max_text_line_w;
+    s->layout_h       = y + s->max_glyph_h;
+    s->layout_ascent  = y_max;
+    s->layout_descent = y_min;
+    s->layout_text    = av_strdup(text);
+
+layout_done:
     s->var_values[VAR_TW] = s->var_values[VAR_TEXT_W] = max_text_line_w;
     s->var_values[VAR_TH] = s->var_values[VAR_TEXT_H] = y + s->max_glyph_h;
 
@@ -36,7 +36,10 @@
 typedef struct {
     const AVClass *class;
 
-    RDFTContext *rdft;
+    RDFTContext *hrdft[MAX_PLANES];
+    RDFTContext *vrdft[MAX_PLANES];
+    RDFTContext *ihrdft[MAX_PLANES];
+    RDFTContext *ivrdft[MAX_PLANES];
     int rdft_hbits[MAX_PLANES];
     int rdft_vbits[MAX_PLANES];
     size_t rdft_hlen[MAX_PLANES];
@@ -96,7 +99,6 @@ static void copy_rev (FFTSample *dest, int w, int w2)
 static void rdft_horizontal(FFTFILTContext *s, AVFrame *in, int w, int h, int plane)
 {
     int i, j;
-    s->rdft = av_rdft_init(s->rdft_hbits[plane], DFT_R2C);
 
     for (i = 0; i < h; i++) {
         for (j = 0; j < w; j++)
@@ -105,17 +107,13 @@ static void rdft_horizontal(FFTFILTContext *s, AVFrame *in, int w, int h, int pl
         copy_rev(s->rdft_hdata[plane] + i * s->rdft_hlen[plane], w, s->rdft_hlen[plane]);
     }
 
-    for (i = 0; i < h; i++)
-        av_rdft_calc(s->rdft, s->rdft_hdata[plane] + i * s->rdft_hlen[plane]);
-
-    av_rdft_end(s->rdft);
+    av_rdft_calc_batch(s->hrdft[plane], s->rdft_hdata[plane], s->rdft_hlen[plane], h);
 }
 
 /*Vertical pass - RDFT*/
 static void rdft_vertical(FFTFILTContext *s, int h, int plane)
 {
     int i, j;
-    s->rdft = av_rdft_init(s->rdft_vbits[plane], DFT_R2C);
 
     for (i = 0; i < s->rdft_hlen[plane]; i++) {
         for (j = 0; j < h; j++)
@@ -124,34 +122,29 @@ static void rdft_vertical(FFTFILTContext *s, int h, int plane)
         copy_rev(s->rdft_vdata[plane] + i * s->rdft_vlen[plane], h, s->rdft_vlen[plane]);
     }
 
-    for (i = 0; i < s->rdft_hlen[plane]; i++)
-        av_rdft_calc(s->rdft, s->rdft_vdata[plane] + i * s->rdft_vlen[plane]);
-
-    av_rdft_end(s->rdft);
+    av_rdft_calc_batch(s->vrdft[plane], s->rdft_vdata[plane], s->rdft_vlen[plane],
+                       s->rdft_hlen[plane]);
 }
 /*Vertical pass - IRDFT*/
 static void irdft_vertical(FFTFILTContext *s, int h, int plane)
 {
     int i, j;
-    s->rdft = av_rdft_init(s->rdft_vbits[plane], IDFT_C2R);
-    for (i = 0; i < s->rdft_hlen[plane]; i++)
-        av_rdft_calc(s->rdft, s->rdft_vdata[plane] + i * s->rdft_vlen[plane]);
+
+    av_rdft_calc_batch(s->ivrdft[plane], s->rdft_vdata[plane], s->rdft_vlen[plane],
+                       s->rdft_hlen[plane]);
 
     for (i = 0; i < s->rdft_hlen[plane]; i++)
         for (j = 0; j < h; j++)
             s->rdft_hdata[plane][j * s->rdft_hlen[plane] + i] =
             s->rdft_vdata[plane][i * s->rdft_vlen[plane] + j];
-
-    av_rdft_end(s->rdft);
 }
 
 /*Horizontal pass - IRDFT*/
 static void irdft_horizontal(FFTFILTContext *s, AVFrame *out, int w, int h, int plane)
 {
     int i, j;
-    s->rdft = av_rdft_init(s->rdft_hbits[plane], IDFT_C2R);
-    for (i = 0; i < h; i++)
-        av_rdft_calc(s->rdft, s->rdft_hdata[plane] + i * s->rdft_hlen[plane]);
+
+    av_rdft_calc_batch(s->ihrdft[plane], s->rdft_hdata[plane], s->rdft_hlen[plane], h);
 
     for (i = 0; i < h; i++)
         for (j = 0; j < w; j++)
@@ -159,8 +152,6 @@ static void irdft_horizontal(FFTFILTContext *s, AVFrame *out, int w, int h, int
                                                                          *s->rdft_hlen[plane] + j] * 4 /
                                                                          (s->rdft_hlen[plane] *
                                                                           s->rdft_vlen[plane]), 0, 255);
-
-    av_rdft_end(s->rdft);
 }
 
 static av_cold int initialize(AVFilterContext *ctx)
@@ -215,6 +206,9 @@ static int config_props(AVFilterLink *inlink)
         s->rdft_hlen[i] = 1 << rdft_hbits;
         if (!(s->rdft_hdata[i] = av_malloc_array(h, s->rdft_hlen[i] * sizeof(FFTSample))))
             return AVERROR(ENOMEM);
+        if (!(s->hrdft[i]  = av_rdft_init(rdft_hbits, DFT_R2C)) ||
+            !(s->ihrdft[i] = av_rdft_init(rdft_hbits, IDFT_C2R)))
+            return AVERROR(ENOMEM);
 
         /* RDFT - Array initialization for Vertical pass*/
         for (rdft_vbits = 1; 1 << rdft_vbits < h*10/9; rdft_vbits++);
@@ -222,6 +216,9 @@ static int config_props(AVFilterLink *inlink)
         s->rdft_vlen[i] = 1 << rdft_vbits;
         if (!(s->rdft_vdata[i] = av_malloc_array(s->rdft_hlen[i], s->rdft_vlen[i] * sizeof(FFTSample))))
             return AVERROR(ENOMEM);
+        if (!(s->vrdft[i]  = av_rdft_init(rdft_vbits, DFT_R2C)) ||
+            !(s->ivrdft[i] = av_rdft_init(rdft_vbits, IDFT_C2R)))
+            return AVERROR(ENOMEM);
     }
 
     /*Luminance value - Array initialization*/
@@ -296,6 +293,10 @@ static av_cold void uninit(AVFilterContext *ctx)
     for (i = 0; i < MAX_PLANES; i++) {
         av_free(s->rdft_hdata[i]);
         av_free(s->rdft_vdata[i]);
+        av_rdft_end(s->hrdft[i]);
+        av_rdft_end(s->vrdft[i]);
+        av_rdft_end(s->ihrdft[i]);
+        av_rdft_end(s->ivrdft[i]);
         av_expr_free(s->weight_expr[i]);
         av_free(s->weight[i]);
     }
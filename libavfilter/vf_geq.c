@@ -33,14 +33,18 @@
 #include "libavutil/pixdesc.h"
 #include "internal.h"
 
+#define MAX_THREADS 16
+
 typedef struct {
     const AVClass *class;
-    AVExpr *e[4];               ///< expressions for each plane
+    AVExpr *e[4][MAX_THREADS];  ///< expressions for each plane and thread
     char *expr_str[4+3];        ///< expression strings for each plane
     AVFrame *picref;            ///< current input buffer
     int hsub, vsub;             ///< chroma subsampling
     int planes;                 ///< number of planes
     int is_rgb;
+    int nb_threads;
+    int stateful;               ///< an expression uses st(), ld() or random()
 } GEQContext;
 
 enum { Y = 0, U, V, A, G, B, R };
@@ -101,6 +105,54 @@ static double alpha(void *priv, double x, double y) { return getpix(priv, x, y,
 static const char *const var_names[] = {   "X",   "Y",   "W",   "H",   "N",   "SW",   "SH",   "T",        NULL };
 enum                                   { VAR_X, VAR_Y, VAR_W, VAR_H, VAR_N, VAR_SW, VAR_SH, VAR_T, VAR_VARS_NB };
 
+static int geq_parse_plane(AVFilterContext *ctx, AVExpr **e, int plane)
+{
+    GEQContext *geq = ctx->priv;
+    static double (*p[])(void *, double, double) = { lum, cb, cr, alpha };
+    static const char *const func2_yuv_names[]    = { "lum", "cb", "cr", "alpha", "p", NULL };
+    static const char *const func2_rgb_names[]    = { "g", "b", "r", "alpha", "p", NULL };
+    const char *const *func2_names       = geq->is_rgb ? func2_rgb_names : func2_yuv_names;
+    double (*func2[])(void *, double, double) = { lum, cb, cr, alpha, p[plane], NULL };
+
+    return av_expr_parse(e, geq->expr_str[plane < 3 && geq->is_rgb ? plane+4 : plane], var_names,
+                         NULL, NULL, func2_names, func2, 0, ctx);
+}
+
+#define IS_IDENTIFIER_CHAR(c) ((c) - '0' <= 9U || (c) - 'a' <= 25U || (c) - 'A' <= 25U || (c) == '_')
+
+/**
+ * Check whether the expression calls st(), ld() or random(). Their state
+ * lives in the expression, so splitting the picture into slices with one
+ * expression copy each would change the result.
+ */
+static int expr_uses_state(const char *s)
+{
+    static const char *const names[] = { "st", "ld", "random" };
+    char buf[16];
+    int i, len = 0;
+
+    for (;; s++) {
+        /* whitespace is ignored by the parser, even inside names */
+        if (av_isspace(*s))
+            continue;
+        if (IS_IDENTIFIER_CHAR(*s)) {
+            if (len < sizeof(buf) - 1)
+                buf[len] = *s;
+            len++;
+            continue;
+        }
+        if (*s == '(' && len < sizeof(buf)) {
+            buf[len] = 0;
+            for (i = 0; i < FF_ARRAY_ELEMS(names); i++)
+                if (!strcmp(buf, names[i]))
+                    return 1;
+        }
+        if (!*s)
+            return 0;
+        len = 0;
+    }
+}
+
 static av_cold int geq_init(AVFilterContext *ctx)
 {
     GEQContext *geq = ctx->priv;
@@ -147,17 +199,12 @@ static av_cold int geq_init(AVFilterContext *ctx)
     }
 
     for (plane = 0; plane < 4; plane++) {
-        static double (*p[])(void *, double, double) = { lum, cb, cr, alpha };
-        static const char *const func2_yuv_names[]    = { "lum", "cb", "cr", "alpha", "p", NULL };
-        static const char *const func2_rgb_names[]    = { "g", "b", "r", "alpha", "p", NULL };
-        const char *const *func2_names       = geq->is_rgb ? func2_rgb_names : func2_yuv_names;
-        double (*func2[])(void *, double, double) = { lum, cb, cr, alpha, p[plane], NULL };
-
-        ret = av_expr_parse(&geq->e[plane], geq->expr_str[plane < 3 && geq->is_rgb ? plane+4 : plane], var_names,
-                            NULL, NULL, func2_names, func2, 0, ctx);
+        ret = geq_parse_plane(ctx, &geq->e[plane][0], plane);
         if (ret < 0)
             break;
+        geq->stateful |= expr_uses_state(geq->expr_str[plane < 3 && geq->is_rgb ? plane+4 : plane]);
     }
+    geq->nb_threads = 1;
 
 end:
     return ret;
@@ -190,23 +237,76 @@ static int geq_query_formats(AVFilterContext *ctx)
 
 static int geq_config_props(AVFilterLink *inlink)
 {
-    GEQContext *geq = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
+    GEQContext *geq = ctx->priv;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+    int plane, i, ret;
 
     av_assert0(desc);
 
     geq->hsub = desc->log2_chroma_w;
     geq->vsub = desc->log2_chroma_h;
     geq->planes = desc->nb_components;
+
+    /* the evaluator state (st() and ld() variables) is stored in the
+     * expression, so each slice thread needs its own copy */
+    for (plane = 0; plane < 4; plane++)
+        for (i = 1; i < geq->nb_threads; i++) {
+            av_expr_free(geq->e[plane][i]);
+            geq->e[plane][i] = NULL;
+        }
+    geq->nb_threads = geq->stateful ? 1 : FFMIN3(MAX_THREADS, ctx->graph->nb_threads, inlink->h);
+    for (plane = 0; plane < 4; plane++) {
+        for (i = 1; i < geq->nb_threads; i++) {
+            ret = geq_parse_plane(ctx, &geq->e[plane][i], plane);
+            if (ret < 0)
+                return ret;
+        }
+    }
+    return 0;
+}
+
+typedef struct ThreadData {
+    uint8_t *dst;
+    int linesize;
+    int plane;
+    int w, h;
+    double *values;
+} ThreadData;
+
+static int geq_filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    GEQContext *geq = ctx->priv;
+    ThreadData *td = arg;
+    const int slice_start = (td->h *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->h * (jobnr+1)) / nb_jobs;
+    uint8_t *dst = td->dst + slice_start * td->linesize;
+    AVExpr *e = geq->e[td->plane][jobnr];
+    double values[VAR_VARS_NB];
+    int x, y;
+
+    memcpy(values, td->values, sizeof(values));
+
+    for (y = slice_start; y < slice_end; y++) {
+        values[VAR_Y] = y;
+        for (x = 0; x < td->w; x++) {
+            values[VAR_X] = x;
+            dst[x] = av_expr_eval(e, values, geq);
+        }
+        dst += td->linesize;
+    }
+
     return 0;
 }
 
 static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     int plane;
-    GEQContext *geq = inlink->dst->priv;
-    AVFilterLink *outlink = inlink->dst->outputs[0];
+    AVFilterContext *ctx = inlink->dst;
+    GEQContext *geq = ctx->priv;
+    AVFilterLink *outlink = ctx->outputs[0];
     AVFrame *out;
+    ThreadData td;
     double values[VAR_VARS_NB] = {
         [VAR_N] = inlink->frame_count,
         [VAR_T] = in->pts == AV_NOPTS_VALUE ? NAN : in->pts * av_q2d(inlink->time_base),
@@ -221,9 +321,6 @@ static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
     av_frame_copy_props(out, in);
 
     for (plane = 0; plane < geq->planes && out->data[plane]; plane++) {
-        int x, y;
-        uint8_t *dst = out->data[plane];
-        const int linesize = out->linesize[plane];
         const int w = (plane == 1 || plane == 2) ? AV_CEIL_RSHIFT(inlink->w, geq->hsub) : inlink->w;
         const int h = (plane == 1 || plane == 2) ? AV_CEIL_RSHIFT(inlink->h, geq->vsub) : inlink->h;
 
@@ -232,14 +329,13 @@ static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
         values[VAR_SW] = w / (double)inlink->w;
         values[VAR_SH] = h / (double)inlink->h;
 
-        for (y = 0; y < h; y++) {
-            values[VAR_Y] = y;
-            for (x = 0; x < w; x++) {
-                values[VAR_X] = x;
-                dst[x] = av_expr_eval(geq->e[plane], values, geq);
-            }
-            dst += linesize;
-        }
+        td.dst      = out->data[plane];
+        td.linesize = out->linesize[plane];
+        td.plane    = plane;
+        td.w        = w;
+        td.h        = h;
+        td.values   = values;
+        ctx->internal->execute(ctx, geq_filter_slice, &td, NULL, FFMIN(h, geq->nb_threads));
     }
 
     av_frame_free(&geq->picref);
@@ -248,11 +344,12 @@ static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
 
 static av_cold void geq_uninit(AVFilterContext *ctx)
 {
-    int i;
+    int i, j;
     GEQContext *geq = ctx->priv;
 
     for (i = 0; i < FF_ARRAY_ELEMS(geq->e); i++)
-        av_expr_free(geq->e[i]);
+        for (j = 0; j < MAX_THREADS; j++)
+            av_expr_free(geq->e[i][j]);
 }
 
 static const AVFilterPad geq_inputs[] = {
@@ -283,5 +380,5 @@ AVFilter ff_vf_geq = {
     .inputs        = geq_inputs,
     .outputs       = geq_outputs,
     .priv_class    = &geq_class,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -95,7 +95,9 @@ static int pp_query_formats(AVFilterContext *ctx)
 static int pp_config_props(AVFilterLink *inlink)
 {
     int flags = PP_CPU_CAPS_AUTO;
-    PPFilterContext *pp = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
+    PPFilterContext *pp = ctx->priv;
+    int ret;
 
     switch (inlink->format) {
     case AV_PIX_FMT_GRAY8:
@@ -115,6 +117,12 @@ static int pp_config_props(AVFilterLink *inlink)
     pp->pp_ctx = pp_get_context(inlink->w, inlink->h, flags);
     if (!pp->pp_ctx)
         return AVERROR(ENOMEM);
+
+    if (ctx->thread_type & AVFILTER_THREAD_SLICE) {
+        ret = pp_set_threads(pp->pp_ctx, ctx->graph->nb_threads);
+        if (ret < 0)
+            av_log(ctx, AV_LOG_WARNING, "Could not start threads, filtering single threaded\n");
+    }
     return 0;
 }
 
@@ -192,5 +200,5 @@ AVFilter ff_vf_pp = {
     .outputs         = pp_outputs,
     .process_command = pp_process_command,
     .priv_class      = &pp_class,
-    .flags           = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags           = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
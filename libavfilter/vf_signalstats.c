@@ -515,7 +515,8 @@ static int filter_frame(AVFilterLink *link, AVFrame *in)
 
 #define SET_META(key, fmt, val) do {                                \
     snprintf(metabuf, sizeof(metabuf), fmt, val);                   \
-    av_dict_set(&out->metadata, "lavfi.signalstats." key, metabuf, 0);   \
+    av_dict_set(&out->metadata, "lavfi.signalstats." key, metabuf,  \
+                AV_DICT_STATIC_KEY);                                \
 } while (0)
 
     SET_META("YMIN",    "%d", miny);
@@ -28,6 +28,7 @@
  */
 
 #include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
 #include "avfilter.h"
 #include "internal.h"
 
@@ -35,7 +36,7 @@
 
 struct thumb_frame {
     AVFrame *buf;               ///< cached frame
-    int histogram[HIST_SIZE];   ///< RGB color distribution histogram of the frame
+    int histogram[HIST_SIZE];   ///< color distribution histogram of the frame, per component
 };
 
 typedef struct {
@@ -44,6 +45,10 @@ typedef struct {
     int n_frames;               ///< number of frames for analysis
     struct thumb_frame *frames; ///< the n_frames frames
     AVRational tb;              ///< copy of the input timebase to ease access
+    int yuv;                    ///< accept planar YUV input without conversion
+    int planar;                 ///< 8-bit planar YUV input, one histogram per plane
+    int planewidth[3];
+    int planeheight[3];
 } ThumbContext;
 
 #define OFFSET(x) offsetof(ThumbContext, x)
@@ -51,6 +56,7 @@ typedef struct {
 
 static const AVOption thumbnail_options[] = {
     { "n", "set the frames batch size", OFFSET(n_frames), AV_OPT_TYPE_INT, {.i64=100}, 2, INT_MAX, FLAGS },
+    { "yuv", "compute the histograms on planar YUV input", OFFSET(yuv), AV_OPT_TYPE_BOOL, {.i64=0}, 0, 1, FLAGS },
     { NULL }
 };
 
@@ -140,14 +146,29 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
     // keep a reference of each frame
     s->frames[s->n].buf = frame;
 
-    // update current frame RGB histogram
-    for (j = 0; j < inlink->h; j++) {
-        for (i = 0; i < inlink->w; i++) {
-            hist[0*256 + p[i*3    ]]++;
-            hist[1*256 + p[i*3 + 1]]++;
-            hist[2*256 + p[i*3 + 2]]++;
+    // update current frame histogram
+    if (s->planar) {
+        int plane;
+
+        for (plane = 0; plane < 3; plane++) {
+            int *phist = hist + plane * 256;
+
+            p = frame->data[plane];
+            for (j = 0; j < s->planeheight[plane]; j++) {
+                for (i = 0; i < s->planewidth[plane]; i++)
+                    phist[p[i]]++;
+                p += frame->linesize[plane];
+            }
+        }
+    } else {
+        for (j = 0; j < inlink->h; j++) {
+            for (i = 0; i < inlink->w; i++) {
+                hist[0*256 + p[i*3    ]]++;
+                hist[1*256 + p[i*3 + 1]]++;
+                hist[2*256 + p[i*3 + 2]]++;
+            }
+            p += frame->linesize[0];
         }
-        p += frame->linesize[0];
     }
 
     // no selection until the buffer of N frames is filled up
@@ -188,18 +209,33 @@ static int config_props(AVFilterLink *inlink)
 {
     AVFilterContext *ctx = inlink->dst;
     ThumbContext *s = ctx->priv;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
 
     s->tb = inlink->time_base;
+    s->planar = !!(desc->flags & AV_PIX_FMT_FLAG_PLANAR);
+    s->planewidth[0]  = inlink->w;
+    s->planewidth[1]  = s->planewidth[2]  = AV_CEIL_RSHIFT(inlink->w, desc->log2_chroma_w);
+    s->planeheight[0] = inlink->h;
+    s->planeheight[1] = s->planeheight[2] = AV_CEIL_RSHIFT(inlink->h, desc->log2_chroma_h);
     return 0;
 }
 
 static int query_formats(AVFilterContext *ctx)
 {
+    ThumbContext *s = ctx->priv;
+    static const enum AVPixelFormat rgb_pix_fmts[] = {
+        AV_PIX_FMT_RGB24, AV_PIX_FMT_BGR24,
+        AV_PIX_FMT_NONE
+    };
     static const enum AVPixelFormat pix_fmts[] = {
         AV_PIX_FMT_RGB24, AV_PIX_FMT_BGR24,
+        AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUVJ420P,
+        AV_PIX_FMT_YUV422P, AV_PIX_FMT_YUVJ422P,
+        AV_PIX_FMT_YUV444P, AV_PIX_FMT_YUVJ444P,
+        AV_PIX_FMT_YUV411P, AV_PIX_FMT_YUV410P, AV_PIX_FMT_YUV440P,
         AV_PIX_FMT_NONE
     };
-    AVFilterFormats *fmts_list = ff_make_format_list(pix_fmts);
+    AVFilterFormats *fmts_list = ff_make_format_list(s->yuv ? pix_fmts : rgb_pix_fmts);
     if (!fmts_list)
         return AVERROR(ENOMEM);
     return ff_set_common_formats(ctx, fmts_list);
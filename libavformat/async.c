@@ -34,6 +34,7 @@
 #include "libavutil/log.h"
 #include "libavutil/opt.h"
 #include "libavutil/thread.h"
+#include "libavutil/time.h"
 #include "url.h"
 #include <stdint.h>
 
@@ -44,6 +45,7 @@
 #define BUFFER_CAPACITY         (4 * 1024 * 1024)
 #define READ_BACK_CAPACITY      (4 * 1024 * 1024)
 #define SHORT_SEEK_THRESHOLD    (256 * 1024)
+#define WRITE_CHUNK_SIZE        (64 * 1024)
 
 typedef struct RingBuffer
 {
@@ -78,6 +80,9 @@ typedef struct Context {
 
     int             abort_request;
     AVIOInterruptCB interrupt_callback;
+
+    int             write_mode;
+    int64_t         blocked_time;
 } Context;
 
 static int ring_init(RingBuffer *ring, unsigned int capacity, int read_back_capacity)
@@ -237,6 +242,75 @@ static void *async_buffer_task(void *arg)
     return NULL;
 }
 
+static int wrapped_url_write(void *dst, void *src, int size)
+{
+    URLContext *h   = dst;
+    Context    *c   = h->priv_data;
+    int         ret;
+
+    ret = ffurl_write(c->inner, src, size);
+    c->inner_io_error = ret < 0 ? ret : 0;
+
+    return ret;
+}
+
+static void fifo_write_to_url(void *dst, void *src, int size)
+{
+    wrapped_url_write(dst, src, size);
+}
+
+static void *async_write_task(void *arg)
+{
+    URLContext   *h    = arg;
+    Context      *c    = h->priv_data;
+    RingBuffer   *ring = &c->ring;
+
+    while (1) {
+        int fifo_size, to_copy;
+
+        pthread_mutex_lock(&c->mutex);
+        if (async_check_interrupt(h)) {
+            if (!c->io_error && ring_size(ring) > 0)
+                c->io_error = AVERROR_EXIT;
+            pthread_cond_signal(&c->cond_wakeup_main);
+            pthread_mutex_unlock(&c->mutex);
+            break;
+        }
+
+        fifo_size = ring_size(ring);
+        /* seeks are only done once everything before them is written */
+        if (c->seek_request && (!fifo_size || c->io_error)) {
+            c->seek_ret       = c->io_error ? c->io_error :
+                                ffurl_seek(c->inner, c->seek_pos, c->seek_whence);
+            c->seek_completed = 1;
+            c->seek_request   = 0;
+
+            pthread_cond_signal(&c->cond_wakeup_main);
+            pthread_mutex_unlock(&c->mutex);
+            continue;
+        }
+
+        if (!fifo_size || c->io_error) {
+            pthread_cond_signal(&c->cond_wakeup_main);
+            pthread_cond_wait(&c->cond_wakeup_background, &c->mutex);
+            pthread_mutex_unlock(&c->mutex);
+            continue;
+        }
+        pthread_mutex_unlock(&c->mutex);
+
+        to_copy = FFMIN(WRITE_CHUNK_SIZE, fifo_size);
+        ring_generic_read(ring, (void *)h, to_copy, fifo_write_to_url);
+
+        pthread_mutex_lock(&c->mutex);
+        if (c->inner_io_error < 0)
+            c->io_error = c->inner_io_error;
+        pthread_cond_signal(&c->cond_wakeup_main);
+        pthread_mutex_unlock(&c->mutex);
+    }
+
+    return NULL;
+}
+
 static int async_open(URLContext *h, const char *arg, int flags, AVDictionary **options)
 {
     Context         *c = h->priv_data;
@@ -245,7 +319,13 @@ static int async_open(URLContext *h, const char *arg, int flags, AVDictionary **
 
     av_strstart(arg, "async:", &arg);
 
-    ret = ring_init(&c->ring, BUFFER_CAPACITY, READ_BACK_CAPACITY);
+    if ((flags & AVIO_FLAG_READ_WRITE) == AVIO_FLAG_READ_WRITE) {
+        av_log(h, AV_LOG_ERROR, "Opening for both reading and writing is not supported\n");
+        return AVERROR(ENOSYS);
+    }
+    c->write_mode = !!(flags & AVIO_FLAG_WRITE);
+
+    ret = ring_init(&c->ring, BUFFER_CAPACITY, c->write_mode ? 0 : READ_BACK_CAPACITY);
     if (ret < 0)
         goto fifo_fail;
 
@@ -278,7 +358,8 @@ static int async_open(URLContext *h, const char *arg, int flags, AVDictionary **
         goto cond_wakeup_background_fail;
     }
 
-    ret = pthread_create(&c->async_buffer_thread, NULL, async_buffer_task, h);
+    ret = pthread_create(&c->async_buffer_thread, NULL,
+                         c->write_mode ? async_write_task : async_buffer_task, h);
     if (ret) {
         av_log(h, AV_LOG_ERROR, "pthread_create failed : %s\n", av_err2str(ret));
         goto thread_fail;
@@ -303,9 +384,16 @@ fifo_fail:
 static int async_close(URLContext *h)
 {
     Context *c = h->priv_data;
-    int      ret;
+    int      ret, err = 0;
 
     pthread_mutex_lock(&c->mutex);
+    if (c->write_mode) {
+        /* wait for the pending data to be written */
+        while (ring_size(&c->ring) > 0 && !c->io_error && !async_check_interrupt(h)) {
+            pthread_cond_signal(&c->cond_wakeup_background);
+            pthread_cond_wait(&c->cond_wakeup_main, &c->mutex);
+        }
+    }
     c->abort_request = 1;
     pthread_cond_signal(&c->cond_wakeup_background);
     pthread_mutex_unlock(&c->mutex);
@@ -314,13 +402,19 @@ static int async_close(URLContext *h)
     if (ret != 0)
         av_log(h, AV_LOG_ERROR, "pthread_join(): %s\n", av_err2str(ret));
 
+    if (c->write_mode) {
+        err = c->io_error;
+        av_log(h, AV_LOG_VERBOSE, "%"PRId64" bytes written, blocked for %"PRId64" ms\n",
+               c->logical_pos, c->blocked_time / 1000);
+    }
+
     pthread_cond_destroy(&c->cond_wakeup_background);
     pthread_cond_destroy(&c->cond_wakeup_main);
     pthread_mutex_destroy(&c->mutex);
     ffurl_close(c->inner);
     ring_destroy(&c->ring);
 
-    return 0;
+    return err;
 }
 
 static int async_read_internal(URLContext *h, void *dest, int size, int read_complete,
@@ -375,6 +469,88 @@ static int async_read(URLContext *h, unsigned char *buf, int size)
     return async_read_internal(h, buf, size, 0, NULL);
 }
 
+static int async_write(URLContext *h, const unsigned char *buf, int size)
+{
+    Context      *c        = h->priv_data;
+    RingBuffer   *ring     = &c->ring;
+    int           to_write = size;
+    int           ret      = 0;
+
+    pthread_mutex_lock(&c->mutex);
+
+    while (to_write > 0) {
+        int fifo_space, to_copy;
+        int64_t t0;
+
+        if (async_check_interrupt(h)) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+        if (c->io_error) {
+            ret = c->io_error;
+            break;
+        }
+        fifo_space = ring_space(ring);
+        to_copy    = FFMIN(to_write, fifo_space);
+        if (to_copy > 0) {
+            ring_generic_write(ring, (void *)buf, to_copy, NULL);
+            buf            += to_copy;
+            c->logical_pos += to_copy;
+            to_write       -= to_copy;
+            continue;
+        }
+
+        /* the ring is full, wait for the I/O thread to make room */
+        t0 = av_gettime_relative();
+        pthread_cond_signal(&c->cond_wakeup_background);
+        pthread_cond_wait(&c->cond_wakeup_main, &c->mutex);
+        c->blocked_time += av_gettime_relative() - t0;
+    }
+
+    pthread_cond_signal(&c->cond_wakeup_background);
+    pthread_mutex_unlock(&c->mutex);
+
+    return ret < 0 ? ret : size;
+}
+
+static int64_t async_write_seek(URLContext *h, int64_t pos, int whence)
+{
+    Context *c = h->priv_data;
+    int64_t  ret;
+
+    if (whence == SEEK_CUR) {
+        pos   += c->logical_pos;
+        whence = SEEK_SET;
+    }
+
+    pthread_mutex_lock(&c->mutex);
+
+    c->seek_request   = 1;
+    c->seek_pos       = pos;
+    c->seek_whence    = whence;
+    c->seek_completed = 0;
+    c->seek_ret       = 0;
+
+    while (1) {
+        if (async_check_interrupt(h)) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+        if (c->seek_completed) {
+            if (c->seek_ret >= 0 && whence != AVSEEK_SIZE)
+                c->logical_pos = c->seek_ret;
+            ret = c->seek_ret;
+            break;
+        }
+        pthread_cond_signal(&c->cond_wakeup_background);
+        pthread_cond_wait(&c->cond_wakeup_main, &c->mutex);
+    }
+
+    pthread_mutex_unlock(&c->mutex);
+
+    return ret;
+}
+
 static void fifo_do_not_copy_func(void* dest, void* src, int size) {
     // do not copy
 }
@@ -388,6 +564,9 @@ static int64_t async_seek(URLContext *h, int64_t pos, int whence)
     int fifo_size;
     int fifo_size_of_read_back;
 
+    if (c->write_mode)
+        return async_write_seek(h, pos, whence);
+
     if (whence == AVSEEK_SIZE) {
         av_log(h, AV_LOG_TRACE, "async_seek: AVSEEK_SIZE: %"PRId64"\n", (int64_t)c->logical_size);
         return c->logical_size;
@@ -483,6 +662,7 @@ const URLProtocol ff_async_protocol = {
     .name                = "async",
     .url_open2           = async_open,
     .url_read            = async_read,
+    .url_write           = async_write,
     .url_seek            = async_seek,
     .url_close           = async_close,
     .priv_data_size      = sizeof(Context),
@@ -1886,6 +1886,20 @@ typedef struct AVFormatContext {
      * - decoding: set by user through AVOptions (NO direct access)
      */
     char *protocol_blacklist;
+
+    /**
+     * Maximum total size, in bytes, of the packets buffered by
+     * av_interleaved_write_frame() while waiting for all the streams to
+     * catch up.
+     *
+     * When the buffered data exceeds this limit, libavformat will output
+     * the earliest packet regardless of whether it has queued a packet for
+     * all the streams, in the same way as for max_interleave_delta.
+     * 0 means no limit.
+     *
+     * Muxing only, set by the caller before avformat_write_header().
+     */
+    int64_t max_interleave_size;
 } AVFormatContext;
 
 int av_format_get_probe_score(const AVFormatContext *s);
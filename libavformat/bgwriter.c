@@ -0,0 +1,240 @@
+/*
+ * Background output finalization for segmenting muxers
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+#include "libavutil/threadmessage.h"
+
+#include "avformat.h"
+#include "bgwriter.h"
+#include "internal.h"
+
+#define BGWRITER_QUEUE_SIZE 16
+
+enum BgJobType {
+    BG_JOB_CLOSE,
+    BG_JOB_FILE,
+    BG_JOB_APPEND,
+};
+
+typedef struct BgJob {
+    enum BgJobType type;
+    AVIOContext *pb;        ///< context to close or append to
+    uint8_t *buf;           ///< data for BG_JOB_FILE and BG_JOB_APPEND
+    int size;
+    char *filename;
+    char *rename_to;
+    AVDictionary *options;
+} BgJob;
+
+struct FFBgWriter {
+    AVFormatContext *s;
+    int error;
+#if HAVE_THREADS
+    AVThreadMessageQueue *queue;
+    pthread_t thread;
+    int thread_started;
+#endif
+};
+
+static void bgwriter_job_free(BgJob *job)
+{
+    av_freep(&job->buf);
+    av_freep(&job->filename);
+    av_freep(&job->rename_to);
+    av_dict_free(&job->options);
+}
+
+static int bgwriter_run_job(FFBgWriter *w, BgJob *job)
+{
+    AVFormatContext *s = w->s;
+    AVIOContext *pb = NULL;
+    int ret = 0;
+
+    switch (job->type) {
+    case BG_JOB_CLOSE:
+        avio_flush(job->pb);
+        ret = job->pb->error;
+        ff_format_io_close(s, &job->pb);
+        break;
+    case BG_JOB_FILE:
+        ret = s->io_open(s, &pb, job->filename, AVIO_FLAG_WRITE, &job->options);
+        if (ret < 0) {
+            av_log(s, AV_LOG_ERROR, "Failed to open '%s'\n", job->filename);
+            break;
+        }
+        avio_write(pb, job->buf, job->size);
+        avio_flush(pb);
+        ret = pb->error;
+        ff_format_io_close(s, &pb);
+        if (ret >= 0 && job->rename_to)
+            ret = ff_rename(job->filename, job->rename_to, s);
+        break;
+    case BG_JOB_APPEND:
+        avio_write(job->pb, job->buf, job->size);
+        avio_flush(job->pb);
+        ret = job->pb->error;
+        break;
+    }
+
+    bgwriter_job_free(job);
+    return ret;
+}
+
+#if HAVE_THREADS
+static void *bgwriter_worker(void *arg)
+{
+    FFBgWriter *w = arg;
+    BgJob job;
+    int ret;
+
+    while (av_thread_message_queue_recv(w->queue, &job, 0) >= 0) {
+        ret = bgwriter_run_job(w, &job);
+        if (ret < 0 && !w->error) {
+            w->error = ret;
+            av_thread_message_queue_set_err_send(w->queue, ret);
+        }
+    }
+    return NULL;
+}
+#endif
+
+static int bgwriter_submit(FFBgWriter *w, BgJob *job)
+{
+    int ret;
+
+#if HAVE_THREADS
+    if (w->thread_started) {
+        ret = av_thread_message_queue_send(w->queue, job, 0);
+        if (ret >= 0)
+            return 0;
+        /* The worker already failed; release the job here. */
+        if (job->type == BG_JOB_CLOSE)
+            ff_format_io_close(w->s, &job->pb);
+        bgwriter_job_free(job);
+        return ret;
+    }
+#endif
+
+    ret = bgwriter_run_job(w, job);
+    if (ret < 0 && !w->error)
+        w->error = ret;
+    return ret;
+}
+
+int ff_bgwriter_alloc(FFBgWriter **pw, AVFormatContext *s, int async)
+{
+    FFBgWriter *w = av_mallocz(sizeof(*w));
+
+    if (!w)
+        return AVERROR(ENOMEM);
+    w->s = s;
+
+    if (async) {
+#if HAVE_THREADS
+        int ret = av_thread_message_queue_alloc(&w->queue, BGWRITER_QUEUE_SIZE,
+                                                sizeof(BgJob));
+        if (ret < 0) {
+            av_free(w);
+            return ret;
+        }
+        ret = pthread_create(&w->thread, NULL, bgwriter_worker, w);
+        if (ret) {
+            av_log(s, AV_LOG_WARNING,
+                   "Failed to start background writer thread, "
+                   "finalizing segments synchronously\n");
+            av_thread_message_queue_free(&w->queue);
+        } else {
+            w->thread_started = 1;
+        }
+#else
+        av_log(s, AV_LOG_WARNING,
+               "Threads are not available, finalizing segments synchronously\n");
+#endif
+    }
+
+    *pw = w;
+    return 0;
+}
+
+int ff_bgwriter_close(FFBgWriter *w, AVIOContext **pb)
+{
+    BgJob job = { .type = BG_JOB_CLOSE, .pb = *pb };
+
+    if (!*pb)
+        return 0;
+    *pb = NULL;
+    return bgwriter_submit(w, &job);
+}
+
+int ff_bgwriter_write_file(FFBgWriter *w, AVIOContext **dyn_pb,
+                           const char *filename, AVDictionary *options,
+                           const char *rename_to)
+{
+    BgJob job = { .type = BG_JOB_FILE };
+    int ret;
+
+    job.size      = avio_close_dyn_buf(*dyn_pb, &job.buf);
+    *dyn_pb       = NULL;
+    job.filename  = av_strdup(filename);
+    job.rename_to = rename_to ? av_strdup(rename_to) : NULL;
+    ret = av_dict_copy(&job.options, options, 0);
+    if (job.size < 0 || !job.filename || (rename_to && !job.rename_to) || ret < 0) {
+        bgwriter_job_free(&job);
+        return AVERROR(ENOMEM);
+    }
+    return bgwriter_submit(w, &job);
+}
+
+int ff_bgwriter_append(FFBgWriter *w, AVIOContext *pb, AVIOContext **dyn_pb)
+{
+    BgJob job = { .type = BG_JOB_APPEND, .pb = pb };
+
+    job.size = avio_close_dyn_buf(*dyn_pb, &job.buf);
+    *dyn_pb  = NULL;
+    if (job.size < 0) {
+        bgwriter_job_free(&job);
+        return AVERROR(ENOMEM);
+    }
+    return bgwriter_submit(w, &job);
+}
+
+int ff_bgwriter_free(FFBgWriter **pw)
+{
+    FFBgWriter *w = *pw;
+    int ret;
+
+    if (!w)
+        return 0;
+
+#if HAVE_THREADS
+    if (w->thread_started) {
+        av_thread_message_queue_set_err_recv(w->queue, AVERROR_EOF);
+        pthread_join(w->thread, NULL);
+        av_thread_message_queue_free(&w->queue);
+    }
+#endif
+
+    ret = w->error;
+    av_freep(pw);
+    return ret;
+}
@@ -0,0 +1,85 @@
+/*
+ * Background output finalization for segmenting muxers
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFORMAT_BGWRITER_H
+#define AVFORMAT_BGWRITER_H
+
+#include "avformat.h"
+
+/**
+ * Serializes the slow tail end of a segment (flushing and closing its
+ * AVIOContext, rewriting and renaming playlists) onto a worker thread, so
+ * that the muxer can start the next segment right away.
+ *
+ * Jobs are executed strictly in submission order, so a playlist queued after
+ * a segment close only becomes visible once that segment is complete.
+ * All I/O goes through the io_open/io_close callbacks of the parent
+ * context, which must therefore be callable from another thread.
+ *
+ * If threads are not available or asynchronous operation was not requested,
+ * every job is run synchronously in the calling thread.
+ */
+typedef struct FFBgWriter FFBgWriter;
+
+/**
+ * Allocate a background writer.
+ *
+ * @param s     parent muxer context, used for I/O callbacks and logging
+ * @param async run jobs on a worker thread if non-zero
+ */
+int ff_bgwriter_alloc(FFBgWriter **w, AVFormatContext *s, int async);
+
+/**
+ * Queue flushing and closing *pb. *pb is set to NULL and must not be
+ * touched by the caller anymore.
+ *
+ * @return 0 on success, or an error raised by a previous job
+ */
+int ff_bgwriter_close(FFBgWriter *w, AVIOContext **pb);
+
+/**
+ * Queue writing the contents of a dynamic buffer into a new file.
+ *
+ * @param dyn_pb    dynamic buffer opened with avio_open_dyn_buf(); it is
+ *                  always consumed and set to NULL
+ * @param filename  name of the file to write
+ * @param options   options passed to io_open, may be NULL; not modified
+ * @param rename_to if not NULL, rename filename to this once it is closed
+ * @return 0 on success, or a negative AVERROR
+ */
+int ff_bgwriter_write_file(FFBgWriter *w, AVIOContext **dyn_pb,
+                           const char *filename, AVDictionary *options,
+                           const char *rename_to);
+
+/**
+ * Queue appending the contents of a dynamic buffer to pb, followed by a
+ * flush. pb must not be accessed by the caller until ff_bgwriter_free()
+ * returned.
+ */
+int ff_bgwriter_append(FFBgWriter *w, AVIOContext *pb, AVIOContext **dyn_pb);
+
+/**
+ * Run all pending jobs, stop the worker and free the writer.
+ *
+ * @return the first error encountered by any job, or 0
+ */
+int ff_bgwriter_free(FFBgWriter **w);
+
+#endif /* AVFORMAT_BGWRITER_H */
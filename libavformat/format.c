@@ -22,6 +22,7 @@
 #include "libavutil/atomic.h"
 #include "libavutil/avstring.h"
 #include "libavutil/bprint.h"
+#include "libavutil/name_index.h"
 #include "libavutil/opt.h"
 
 #include "avio_internal.h"
@@ -42,6 +43,12 @@ static AVOutputFormat *first_oformat = NULL;
 static AVInputFormat **last_iformat = &first_iformat;
 static AVOutputFormat **last_oformat = &first_oformat;
 
+/* registered formats by short name, and muxers by extension */
+FF_NAME_INDEX(iformat_name_index, 1024);
+FF_NAME_INDEX(iformat_ext_index,  1024);
+FF_NAME_INDEX(oformat_name_index, 512);
+FF_NAME_INDEX(oformat_ext_index,  1024);
+
 AVInputFormat *av_iformat_next(const AVInputFormat *f)
 {
     if (f)
@@ -68,6 +75,11 @@ void av_register_input_format(AVInputFormat *format)
 
     if (!format->next)
         last_iformat = &format->next;
+
+    if (*p == format) {
+        ff_name_index_add_list(&iformat_name_index, format->name,       format);
+        ff_name_index_add_list(&iformat_ext_index,  format->extensions, format);
+    }
 }
 
 void av_register_output_format(AVOutputFormat *format)
@@ -80,6 +92,11 @@ void av_register_output_format(AVOutputFormat *format)
 
     if (!format->next)
         last_oformat = &format->next;
+
+    if (*p == format) {
+        ff_name_index_add_list(&oformat_name_index, format->name,       format);
+        ff_name_index_add_list(&oformat_ext_index,  format->extensions, format);
+    }
 }
 
 int av_match_ext(const char *filename, const char *extensions)
@@ -95,6 +112,47 @@ int av_match_ext(const char *filename, const char *extensions)
     return 0;
 }
 
+static int guess_format_score(AVOutputFormat *fmt, const char *short_name,
+                              const char *filename, const char *mime_type)
+{
+    int score = 0;
+
+    if (fmt->name && short_name && av_match_name(short_name, fmt->name))
+        score += 100;
+    if (fmt->mime_type && mime_type && !strcmp(fmt->mime_type, mime_type))
+        score += 10;
+    if (filename && fmt->extensions &&
+        av_match_ext(filename, fmt->extensions)) {
+        score += 5;
+    }
+    return score;
+}
+
+/* The index holds the single names of the lists, a list only matches if its
+ * first name does. The candidates include unrelated formats with colliding
+ * hashes, with match_name set only those with a matching name are scored. */
+static AVOutputFormat *guess_format_indexed(FFNameIndex *idx, const char *key,
+                                            int match_name,
+                                            const char *short_name,
+                                            const char *filename,
+                                            const char *mime_type)
+{
+    AVOutputFormat *fmt, *fmt_found = NULL;
+    unsigned hash = ff_name_index_hash(key, strcspn(key, ",")), i;
+    int score, score_max = 0;
+
+    for (i = 0; (fmt = ff_name_index_get(idx, hash, i)); i++) {
+        if (match_name && !av_match_name(short_name, fmt->name))
+            continue;
+        score = guess_format_score(fmt, short_name, filename, mime_type);
+        if (score > score_max) {
+            score_max = score;
+            fmt_found = fmt;
+        }
+    }
+    return fmt_found;
+}
+
 AVOutputFormat *av_guess_format(const char *short_name, const char *filename,
                                 const char *mime_type)
 {
@@ -109,19 +167,29 @@ AVOutputFormat *av_guess_format(const char *short_name, const char *filename,
         return av_guess_format("image2", NULL, NULL);
     }
 #endif
+    /* A name match outscores anything else, so only the muxers with that
+     * name need to be looked at. Without a name or MIME type match, the
+     * extension alone decides. The candidates from the indexes come in
+     * registration order, so ties resolve like in the full scan. */
+    if (short_name && !oformat_name_index.overflow) {
+        fmt_found = guess_format_indexed(&oformat_name_index, short_name, 1,
+                                         short_name, filename, mime_type);
+        if (fmt_found)
+            return fmt_found;
+    }
+    if (!mime_type && !oformat_ext_index.overflow) {
+        const char *ext = filename ? strrchr(filename, '.') : NULL;
+        if (!ext)
+            return NULL;
+        return guess_format_indexed(&oformat_ext_index, ext + 1, 0,
+                                    short_name, filename, mime_type);
+    }
+
     /* Find the proper file type. */
     fmt_found = NULL;
     score_max = 0;
     while ((fmt = av_oformat_next(fmt))) {
-        score = 0;
-        if (fmt->name && short_name && av_match_name(short_name, fmt->name))
-            score += 100;
-        if (fmt->mime_type && mime_type && !strcmp(fmt->mime_type, mime_type))
-            score += 10;
-        if (filename && fmt->extensions &&
-            av_match_ext(filename, fmt->extensions)) {
-            score += 5;
-        }
+        score = guess_format_score(fmt, short_name, filename, mime_type);
         if (score > score_max) {
             score_max = score;
             fmt_found = fmt;
@@ -164,25 +232,158 @@ enum AVCodecID av_guess_codec(AVOutputFormat *fmt, const char *short_name,
 AVInputFormat *av_find_input_format(const char *short_name)
 {
     AVInputFormat *fmt = NULL;
+
+    if (!short_name)
+        return NULL;
+    if (!iformat_name_index.overflow) {
+        /* full lists such as "matroska,webm" are found by their first name */
+        unsigned hash = ff_name_index_hash(short_name, strcspn(short_name, ",")), i;
+
+        for (i = 0; (fmt = ff_name_index_get(&iformat_name_index, hash, i)); i++)
+            if (av_match_name(short_name, fmt->name))
+                return fmt;
+        return NULL;
+    }
     while ((fmt = av_iformat_next(fmt)))
         if (av_match_name(short_name, fmt->name))
             return fmt;
     return NULL;
 }
 
+enum nodat {
+    NO_ID3,
+    ID3_ALMOST_GREATER_PROBE,
+    ID3_GREATER_PROBE,
+    ID3_GREATER_MAX_PROBE,
+};
+
+/**
+ * Leading signatures of common containers. A match only moves the demuxer
+ * to the front of the probe order, its read_probe() still decides.
+ */
+static const struct {
+    uint8_t offset;
+    uint8_t size;
+    const char magic[7];
+    const char *name;
+} probe_magic[] = {
+    { 0, 4, "\x1A\x45\xDF\xA3", "matroska" },
+    { 4, 4, "ftyp",             "mov"      },
+    { 4, 4, "moov",             "mov"      },
+    { 8, 4, "AVI ",             "avi"      },
+    { 8, 4, "WAVE",             "wav"      },
+    { 0, 4, "OggS",             "ogg"      },
+    { 0, 4, "fLaC",             "flac"     },
+    { 0, 3, "FLV",              "flv"      },
+    { 0, 4, "\x30\x26\xB2\x75", "asf"      },
+    { 0, 4, "\x06\x0E\x2B\x34", "mxf"      },
+    { 0, 4, "FORM",             "aiff"     },
+    { 0, 4, "caff",             "caf"      },
+    { 0, 4, "DKIF",             "ivf"      },
+    { 0, 4, "nut/",             "nut"      },
+};
+
+#define MAX_PROBE_HINTS 8
+
+static int is_probe_hint(AVInputFormat **hints, int nb_hints, AVInputFormat *fmt)
+{
+    int i;
+
+    for (i = 0; i < nb_hints; i++)
+        if (hints[i] == fmt)
+            return 1;
+    return 0;
+}
+
+static int add_probe_hint(AVInputFormat **hints, int nb_hints, AVInputFormat *fmt)
+{
+    if (!fmt || nb_hints >= MAX_PROBE_HINTS || is_probe_hint(hints, nb_hints, fmt))
+        return nb_hints;
+    hints[nb_hints] = fmt;
+    return nb_hints + 1;
+}
+
+/**
+ * Collect the demuxers most likely to match: those whose signature is found
+ * at the start of the buffer, then those registered for the file extension.
+ * @param nb_magic set to the number of demuxers found by their signature
+ */
+static int get_probe_hints(const AVProbeData *pd, AVInputFormat **hints,
+                           int *nb_magic)
+{
+    const char *ext = pd->filename ? strrchr(pd->filename, '.') : NULL;
+    int i, nb_hints = 0;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(probe_magic); i++)
+        if (pd->buf_size >= probe_magic[i].offset + probe_magic[i].size &&
+            !memcmp(pd->buf + probe_magic[i].offset, probe_magic[i].magic,
+                    probe_magic[i].size))
+            nb_hints = add_probe_hint(hints, nb_hints,
+                                      av_find_input_format(probe_magic[i].name));
+    *nb_magic = nb_hints;
+
+    if (ext && !iformat_ext_index.overflow) {
+        unsigned hash = ff_name_index_hash(ext + 1, strlen(ext + 1));
+        AVInputFormat *fmt;
+
+        for (i = 0; (fmt = ff_name_index_get(&iformat_ext_index, hash, i)); i++)
+            if (av_match_ext(pd->filename, fmt->extensions))
+                nb_hints = add_probe_hint(hints, nb_hints, fmt);
+    }
+
+    return nb_hints;
+}
+
+/**
+ * @return the probe score of fmt, or -1 if fmt is not to be probed
+ */
+static int probe_score(AVInputFormat *fmt1, AVProbeData *lpd, int is_opened,
+                       enum nodat nodat)
+{
+    int score = 0;
+
+    if (!is_opened == !(fmt1->flags & AVFMT_NOFILE) && strcmp(fmt1->name, "image2"))
+        return -1;
+    if (fmt1->read_probe) {
+        score = fmt1->read_probe(lpd);
+        if (score)
+            av_log(NULL, AV_LOG_TRACE, "Probing %s score:%d size:%d\n", fmt1->name, score, lpd->buf_size);
+        if (fmt1->extensions && av_match_ext(lpd->filename, fmt1->extensions)) {
+            switch (nodat) {
+            case NO_ID3:
+                score = FFMAX(score, 1);
+                break;
+            case ID3_GREATER_PROBE:
+            case ID3_ALMOST_GREATER_PROBE:
+                score = FFMAX(score, AVPROBE_SCORE_EXTENSION / 2 - 1);
+                break;
+            case ID3_GREATER_MAX_PROBE:
+                score = FFMAX(score, AVPROBE_SCORE_EXTENSION);
+                break;
+            }
+        }
+    } else if (fmt1->extensions) {
+        if (av_match_ext(lpd->filename, fmt1->extensions))
+            score = AVPROBE_SCORE_EXTENSION;
+    }
+    if (av_match_name(lpd->mime_type, fmt1->mime_type)) {
+        if (AVPROBE_SCORE_MIME > score) {
+            av_log(NULL, AV_LOG_DEBUG, "Probing %s score:%d increased to %d due to MIME type\n", fmt1->name, score, AVPROBE_SCORE_MIME);
+            score = AVPROBE_SCORE_MIME;
+        }
+    }
+    return score;
+}
+
 AVInputFormat *av_probe_input_format3(AVProbeData *pd, int is_opened,
                                       int *score_ret)
 {
     AVProbeData lpd = *pd;
     AVInputFormat *fmt1 = NULL, *fmt;
-    int score, score_max = 0;
+    AVInputFormat *hints[MAX_PROBE_HINTS];
+    int score, score_max = 0, nb_hints, nb_magic, i;
     const static uint8_t zerobuffer[AVPROBE_PADDING_SIZE];
-    enum nodat {
-        NO_ID3,
-        ID3_ALMOST_GREATER_PROBE,
-        ID3_GREATER_PROBE,
-        ID3_GREATER_MAX_PROBE,
-    } nodat = NO_ID3;
+    enum nodat nodat = NO_ID3;
 
     if (!lpd.buf)
         lpd.buf = (unsigned char *) zerobuffer;
@@ -200,44 +401,37 @@ AVInputFormat *av_probe_input_format3(AVProbeData *pd, int is_opened,
             nodat = ID3_GREATER_PROBE;
     }
 
+    /* The result does not depend on the order in which the demuxers are
+     * probed, as long as every one of them is. Probe the likely candidates
+     * first. Probing stops early only when a demuxer found by its signature
+     * is certain, since no other demuxer can be certain about such a file;
+     * otherwise a tie at AVPROBE_SCORE_MAX still gives no result. */
+    nb_hints = get_probe_hints(&lpd, hints, &nb_magic);
+
     fmt = NULL;
-    while ((fmt1 = av_iformat_next(fmt1))) {
-        if (!is_opened == !(fmt1->flags & AVFMT_NOFILE) && strcmp(fmt1->name, "image2"))
-            continue;
-        score = 0;
-        if (fmt1->read_probe) {
-            score = fmt1->read_probe(&lpd);
-            if (score)
-                av_log(NULL, AV_LOG_TRACE, "Probing %s score:%d size:%d\n", fmt1->name, score, lpd.buf_size);
-            if (fmt1->extensions && av_match_ext(lpd.filename, fmt1->extensions)) {
-                switch (nodat) {
-                case NO_ID3:
-                    score = FFMAX(score, 1);
-                    break;
-                case ID3_GREATER_PROBE:
-                case ID3_ALMOST_GREATER_PROBE:
-                    score = FFMAX(score, AVPROBE_SCORE_EXTENSION / 2 - 1);
-                    break;
-                case ID3_GREATER_MAX_PROBE:
-                    score = FFMAX(score, AVPROBE_SCORE_EXTENSION);
-                    break;
-                }
-            }
-        } else if (fmt1->extensions) {
-            if (av_match_ext(lpd.filename, fmt1->extensions))
-                score = AVPROBE_SCORE_EXTENSION;
-        }
-        if (av_match_name(lpd.mime_type, fmt1->mime_type)) {
-            if (AVPROBE_SCORE_MIME > score) {
-                av_log(NULL, AV_LOG_DEBUG, "Probing %s score:%d increased to %d due to MIME type\n", fmt1->name, score, AVPROBE_SCORE_MIME);
-                score = AVPROBE_SCORE_MIME;
-            }
+    for (i = 0; ; i++) {
+        if (i < nb_hints) {
+            fmt1 = hints[i];
+        } else {
+            /* then all the others, in registration order */
+            fmt1 = av_iformat_next(i == nb_hints ? NULL : fmt1);
+            if (!fmt1)
+                break;
+            if (is_probe_hint(hints, nb_hints, fmt1))
+                continue;
         }
+
+        score = probe_score(fmt1, &lpd, is_opened, nodat);
+        if (score < 0)
+            continue;
         if (score > score_max) {
             score_max = score;
             fmt       = fmt1;
         } else if (score == score_max)
             fmt = NULL;
+
+        if (fmt && score_max >= AVPROBE_SCORE_MAX && i < nb_magic)
+            break;
     }
     if (nodat == ID3_GREATER_PROBE)
         score_max = FFMIN(AVPROBE_SCORE_EXTENSION / 2 - 1, score_max);
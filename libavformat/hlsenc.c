@@ -36,6 +36,7 @@
 
 #include "avformat.h"
 #include "avio_internal.h"
+#include "bgwriter.h"
 #include "internal.h"
 #include "os_support.h"
 
@@ -126,6 +127,8 @@ typedef struct HLSContext {
 
     char *method;
 
+    int async_close;
+    FFBgWriter *bgwriter;
 } HLSContext;
 
 static int hls_delete_old_segments(HLSContext *hls) {
@@ -429,7 +432,7 @@ static int hls_window(AVFormatContext *s, int last)
 
     set_http_options(&options, hls);
     snprintf(temp_filename, sizeof(temp_filename), use_rename ? "%s.tmp" : "%s", s->filename);
-    if ((ret = s->io_open(s, &out, temp_filename, AVIO_FLAG_WRITE, &options)) < 0)
+    if ((ret = avio_open_dyn_buf(&out)) < 0)
         goto fail;
 
     for (en = hls->segments; en; en = en->next) {
@@ -484,7 +487,7 @@ static int hls_window(AVFormatContext *s, int last)
         avio_printf(out, "#EXT-X-ENDLIST\n");
 
     if( hls->vtt_m3u8_name ) {
-        if ((ret = s->io_open(s, &sub_out, hls->vtt_m3u8_name, AVIO_FLAG_WRITE, &options)) < 0)
+        if ((ret = avio_open_dyn_buf(&sub_out)) < 0)
             goto fail;
         avio_printf(sub_out, "#EXTM3U\n");
         avio_printf(sub_out, "#EXT-X-VERSION:%d\n", version);
@@ -512,12 +515,17 @@ static int hls_window(AVFormatContext *s, int last)
 
     }
 
+    /* Queued behind the close of the segment they reference. */
+    ret = ff_bgwriter_write_file(hls->bgwriter, &out, temp_filename, options,
+                                 use_rename ? s->filename : NULL);
+    if (ret >= 0 && sub_out)
+        ret = ff_bgwriter_write_file(hls->bgwriter, &sub_out, hls->vtt_m3u8_name,
+                                     options, NULL);
+
 fail:
     av_dict_free(&options);
-    ff_format_io_close(s, &out);
-    ff_format_io_close(s, &sub_out);
-    if (ret >= 0 && use_rename)
-        ff_rename(temp_filename, s->filename, s);
+    ffio_free_dyn_buf(&out);
+    ffio_free_dyn_buf(&sub_out);
     return ret;
 }
 
@@ -752,6 +760,9 @@ static int hls_write_header(AVFormatContext *s)
     if ((ret = hls_mux_init(s)) < 0)
         goto fail;
 
+    if ((ret = ff_bgwriter_alloc(&hls->bgwriter, s, hls->async_close)) < 0)
+        goto fail;
+
     if ((ret = hls_start(s)) < 0)
         goto fail;
 
@@ -781,6 +792,7 @@ fail:
 
     av_dict_free(&options);
     if (ret < 0) {
+        ff_bgwriter_free(&hls->bgwriter);
         av_freep(&hls->basename);
         av_freep(&hls->vtt_basename);
         if (hls->avf)
@@ -846,9 +858,11 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
                 av_opt_set(hls->avf->priv_data, "mpegts_flags", "resend_headers", 0);
             hls->number++;
         } else {
-            ff_format_io_close(s, &oc->pb);
-            if (hls->vtt_avf)
-                ff_format_io_close(s, &hls->vtt_avf->pb);
+            ret = ff_bgwriter_close(hls->bgwriter, &oc->pb);
+            if (hls->vtt_avf && ret >= 0)
+                ret = ff_bgwriter_close(hls->bgwriter, &hls->vtt_avf->pb);
+            if (ret < 0)
+                return ret;
 
             ret = hls_start(s);
         }
@@ -875,11 +889,12 @@ static int hls_write_trailer(struct AVFormatContext *s)
     HLSContext *hls = s->priv_data;
     AVFormatContext *oc = hls->avf;
     AVFormatContext *vtt_oc = hls->vtt_avf;
+    int ret;
 
     av_write_trailer(oc);
     if (oc->pb) {
         hls->size = avio_tell(hls->avf->pb) - hls->start_pos;
-        ff_format_io_close(s, &oc->pb);
+        ff_bgwriter_close(hls->bgwriter, &oc->pb);
         hls_append_segment(s, hls, hls->duration, hls->start_pos, hls->size);
     }
 
@@ -887,7 +902,7 @@ static int hls_write_trailer(struct AVFormatContext *s)
         if (vtt_oc->pb)
             av_write_trailer(vtt_oc);
         hls->size = avio_tell(hls->vtt_avf->pb) - hls->start_pos;
-        ff_format_io_close(s, &vtt_oc->pb);
+        ff_bgwriter_close(hls->bgwriter, &vtt_oc->pb);
     }
     av_freep(&hls->basename);
     avformat_free_context(oc);
@@ -900,10 +915,11 @@ static int hls_write_trailer(struct AVFormatContext *s)
 
     hls->avf = NULL;
     hls_window(s, 1);
+    ret = ff_bgwriter_free(&hls->bgwriter);
 
     hls_free_segments(hls->segments);
     hls_free_segments(hls->old_segments);
-    return 0;
+    return ret;
 }
 
 #define OFFSET(x) offsetof(HLSContext, x)
@@ -933,6 +949,7 @@ static const AVOption options[] = {
     {"event", "EVENT playlist", 0, AV_OPT_TYPE_CONST, {.i64 = PLAYLIST_TYPE_EVENT }, INT_MIN, INT_MAX, E, "pl_type" },
     {"vod", "VOD playlist", 0, AV_OPT_TYPE_CONST, {.i64 = PLAYLIST_TYPE_VOD }, INT_MIN, INT_MAX, E, "pl_type" },
     {"method", "set the HTTP method", OFFSET(method), AV_OPT_TYPE_STRING, {.str = NULL},  0, 0,    E},
+    {"hls_async_close", "finalize segments and playlists in a background thread", OFFSET(async_close), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, E},
 
     { NULL },
 };
@@ -125,6 +125,12 @@ struct AVFormatInternal {
      */
     int header_written;
     int write_header_ret;
+
+    /**
+     * Total size in bytes of the packets in packet_buffer.
+     * Muxing only.
+     */
+    int64_t packet_buffer_size;
 };
 
 struct AVStreamInternal {
@@ -162,6 +168,13 @@ struct AVStreamInternal {
      * Whether the internal avctx needs to be updated from codecpar (after a late change to codecpar)
      */
     int need_context_update;
+
+    /**
+     * Number of packets of this stream currently in packet_buffer, and the
+     * largest value it reached. Muxing only.
+     */
+    int nb_interleaved_packets;
+    int max_interleaved_packets;
 };
 
 #ifdef __GNUC__
@@ -201,6 +214,14 @@ int ff_hex_to_data(uint8_t *data, const char *p);
 int ff_interleave_add_packet(AVFormatContext *s, AVPacket *pkt,
                              int (*compare)(AVFormatContext *, AVPacket *, AVPacket *));
 
+/**
+ * Update the interleaving queue statistics after pktl has been unlinked
+ * from AVFormatContext->packet_buffer. Must be called by muxers which
+ * implement their own interleave_packet() on top of
+ * ff_interleave_add_packet().
+ */
+void ff_interleave_remove_packet(AVFormatContext *s, AVPacketList *pktl);
+
 void ff_read_frame_flush(AVFormatContext *s);
 
 #define NTP_OFFSET 2208988800ULL
@@ -352,6 +352,11 @@ typedef struct MatroskaDemuxContext {
 
     /* WebM DASH Manifest live flag/ */
     int is_live;
+
+    /* Clusters in [index_gap_start, index_gap_end) were skipped by a
+     * bisecting seek, so keyframes in there may be missing from the index. */
+    int64_t index_gap_start;
+    int64_t index_gap_end;
 } MatroskaDemuxContext;
 
 typedef struct MatroskaBlock {
@@ -3334,13 +3339,91 @@ static int matroska_read_packet(AVFormatContext *s, AVPacket *pkt)
     return 0;
 }
 
+/*
+ * Find the first Cluster starting in [pos, end) and read its Timecode.
+ * Return: the position of the Cluster or a negative value if none was found.
+ */
+static int64_t matroska_probe_cluster(MatroskaDemuxContext *matroska,
+                                      int64_t pos, int64_t end,
+                                      uint64_t *timecode)
+{
+    AVIOContext *pb = matroska->ctx->pb;
+    uint32_t id;
+
+    if (avio_seek(pb, pos, SEEK_SET) < 0)
+        return -1;
+
+    id = avio_rb32(pb);
+    while (!avio_feof(pb) && avio_tell(pb) - 4 < end) {
+        if (id == MATROSKA_ID_CLUSTER) {
+            int64_t cluster_pos = avio_tell(pb) - 4;
+            uint64_t length, size;
+
+            /* the Timecode is mandatory and should be the first child */
+            if (ebml_read_length(matroska, pb, &length) > 0 &&
+                avio_r8(pb) == MATROSKA_ID_CLUSTERTIMECODE &&
+                ebml_read_num(matroska, pb, 8, &size) > 0 &&
+                size > 0 && size <= 8 &&
+                !ebml_read_uint(pb, size, timecode) && !avio_feof(pb))
+                return cluster_pos;
+
+            if (avio_seek(pb, cluster_pos + 4, SEEK_SET) < 0)
+                return -1;
+            id = avio_rb32(pb);
+            continue;
+        }
+        id = (id << 8) | avio_r8(pb);
+    }
+
+    return -1;
+}
+
+#define MATROSKA_BISECT_MIN_SIZE (1 << 20)
+
+/*
+ * Bisect the part of the file after start, using the Cluster timecodes, to
+ * find a Cluster starting at or before timestamp (in the time base of the
+ * stream of track) and as close as possible to it, so that the index can be
+ * completed from there instead of from the last known entry.
+ * Return: the position to start parsing Clusters from.
+ */
+static int64_t matroska_bisect_clusters(MatroskaDemuxContext *matroska,
+                                        MatroskaTrack *track,
+                                        int64_t start, int64_t timestamp)
+{
+    AVIOContext *pb = matroska->ctx->pb;
+    int64_t lo = start, hi = avio_size(pb);
+
+    if (!track || !pb->seekable || matroska->is_live || hi <= 0)
+        return start;
+
+    while (hi - lo > MATROSKA_BISECT_MIN_SIZE) {
+        int64_t mid = lo + (hi - lo) / 2;
+        uint64_t timecode;
+        int64_t pos = matroska_probe_cluster(matroska, mid, hi, &timecode);
+
+        /* blocks get cluster_time + block_time - codec delay as timestamps
+         * in the stream time base, which already includes the
+         * TrackTimecodeScale, see matroska_parse_block() */
+        if (pos < 0 || (int64_t)timecode - track->codec_delay_in_track_tb > timestamp)
+            hi = mid;
+        else
+            lo = pos;
+    }
+
+    if (lo != start)
+        av_log(matroska->ctx, AV_LOG_DEBUG,
+               "Bisected clusters from %"PRId64" to %"PRId64"\n", start, lo);
+    return lo;
+}
+
 static int matroska_read_seek(AVFormatContext *s, int stream_index,
                               int64_t timestamp, int flags)
 {
     MatroskaDemuxContext *matroska = s->priv_data;
     MatroskaTrack *tracks = NULL;
     AVStream *st = s->streams[stream_index];
-    int i, index, index_sub, index_min;
+    int i, index, prev, gap, index_sub, index_min;
 
     /* Parse the CUES now since we need the index data to seek. */
     if (matroska->cues_parsing_deferred > 0) {
@@ -3352,14 +3435,58 @@ static int matroska_read_seek(AVFormatContext *s, int stream_index,
         goto err;
     timestamp = FFMAX(timestamp, st->index_entries[0].timestamp);
 
-    if ((index = av_index_search_timestamp(st, timestamp, flags)) < 0 || index == st->nb_index_entries - 1) {
-        avio_seek(s->pb, st->index_entries[st->nb_index_entries - 1].pos,
-                  SEEK_SET);
-        matroska->current_id = 0;
-        while ((index = av_index_search_timestamp(st, timestamp, flags)) < 0 || index == st->nb_index_entries - 1) {
-            matroska_clear_queue(matroska);
-            if (matroska_parse_cluster(matroska) < 0)
+    index = av_index_search_timestamp(st, timestamp, flags);
+    prev  = av_index_search_timestamp(st, timestamp, AVSEEK_FLAG_BACKWARD);
+    gap   = matroska->index_gap_end > 0 && prev >= 0 && prev < st->nb_index_entries - 1 &&
+            st->index_entries[prev].pos      < matroska->index_gap_end &&
+            st->index_entries[prev + 1].pos >= matroska->index_gap_start;
+    if (index < 0 || index == st->nb_index_entries - 1 || gap) {
+        MatroskaTrack *track = NULL;
+        int64_t start = st->index_entries[FFMAX(prev, 0)].pos;
+        int64_t pos = start, end, step = MATROSKA_BISECT_MIN_SIZE;
+        uint64_t timecode;
+
+        tracks = matroska->tracks.elem;
+        for (i = 0; i < matroska->tracks.nb_elem; i++)
+            if (tracks[i].stream == st)
+                track = &tracks[i];
+        /* only one gap is tracked */
+        if (!matroska->index_gap_end)
+            pos = matroska_bisect_clusters(matroska, track, start, timestamp);
+        for (;;) {
+            avio_seek(s->pb, pos, SEEK_SET);
+            matroska->current_id = 0;
+            /* parse until a keyframe after the target was found in the
+             * Clusters read from pos on */
+            for (;;) {
+                end   = avio_tell(s->pb);
+                index = av_index_search_timestamp(st, timestamp, flags);
+                if (index >= 0 && index < st->nb_index_entries - 1 &&
+                    st->index_entries[index + 1].pos >= pos &&
+                    st->index_entries[index + 1].pos <  end)
+                    break;
+                matroska_clear_queue(matroska);
+                if (matroska_parse_cluster(matroska) < 0)
+                    break;
+            }
+            /* Unless the entry found comes from the Clusters read from pos
+             * on, a keyframe skipped between start and pos may be the right
+             * one, so read more from further back. */
+            if (pos <= start || (index >= 0 && st->index_entries[index].pos >= pos))
                 break;
+            if (pos - start <= step ||
+                (pos = matroska_probe_cluster(matroska, pos - step, pos, &timecode)) < 0)
+                pos = start;
+            step *= 2;
+        }
+
+        if (pos > start && !matroska->index_gap_end) {
+            matroska->index_gap_start = start;
+            matroska->index_gap_end   = pos;
+        } else if (pos <= matroska->index_gap_start && end > matroska->index_gap_start) {
+            matroska->index_gap_start = end;
+            if (matroska->index_gap_start >= matroska->index_gap_end)
+                matroska->index_gap_start = matroska->index_gap_end = 0;
         }
     }
 
@@ -1732,11 +1732,45 @@ static int mov_read_strf(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     return 0;
 }
 
+/**
+ * Read a table of big-endian integers of in_size (4 or 8) bytes each.
+ * The table is read in blocks rather than through one avio_rb32() or
+ * avio_rb64() call per entry, which matters for the sample tables of
+ * long files.
+ * @return the number of entries which were read completely
+ */
+static unsigned mov_read_be_table(AVIOContext *pb, void *dst, int out_size,
+                                  unsigned entries, int in_size)
+{
+    uint8_t buf[4096];
+    unsigned i = 0;
+
+    while (i < entries) {
+        int len = FFMIN(entries - i, sizeof(buf) / in_size) * in_size;
+        int j;
+
+        len = avio_read(pb, buf, len);
+        if (len <= 0)
+            break;
+        for (j = 0; j + in_size <= len; j += in_size, i++) {
+            uint64_t v = in_size == 8 ? AV_RB64(buf + j) : AV_RB32(buf + j);
+            if (out_size == 8)
+                ((int64_t  *)dst)[i] = v;
+            else
+                ((unsigned *)dst)[i] = v;
+        }
+        if (j < len)
+            break;
+    }
+
+    return i;
+}
+
 static int mov_read_stco(MOVContext *c, AVIOContext *pb, MOVAtom atom)
 {
     AVStream *st;
     MOVStreamContext *sc;
-    unsigned int i, entries;
+    unsigned int entries;
 
     if (c->fc->nb_streams < 1)
         return 0;
@@ -1761,16 +1795,14 @@ static int mov_read_stco(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     sc->chunk_count = entries;
 
     if      (atom.type == MKTAG('s','t','c','o'))
-        for (i = 0; i < entries && !pb->eof_reached; i++)
-            sc->chunk_offsets[i] = avio_rb32(pb);
+        sc->chunk_count = mov_read_be_table(pb, sc->chunk_offsets,
+                                            sizeof(*sc->chunk_offsets), entries, 4);
     else if (atom.type == MKTAG('c','o','6','4'))
-        for (i = 0; i < entries && !pb->eof_reached; i++)
-            sc->chunk_offsets[i] = avio_rb64(pb);
+        sc->chunk_count = mov_read_be_table(pb, sc->chunk_offsets,
+                                            sizeof(*sc->chunk_offsets), entries, 8);
     else
         return AVERROR_INVALIDDATA;
 
-    sc->chunk_count = i;
-
     if (pb->eof_reached)
         return AVERROR_EOF;
 
@@ -2416,7 +2448,7 @@ static int mov_read_stps(MOVContext *c, AVIOContext *pb, MOVAtom atom)
 {
     AVStream *st;
     MOVStreamContext *sc;
-    unsigned i, entries;
+    unsigned entries;
 
     if (c->fc->nb_streams < 1)
         return 0;
@@ -2434,12 +2466,8 @@ static int mov_read_stps(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     if (!sc->stps_data)
         return AVERROR(ENOMEM);
 
-    for (i = 0; i < entries && !pb->eof_reached; i++) {
-        sc->stps_data[i] = avio_rb32(pb);
-        //av_log(c->fc, AV_LOG_TRACE, "stps %d\n", sc->stps_data[i]);
-    }
-
-    sc->stps_count = i;
+    sc->stps_count = mov_read_be_table(pb, sc->stps_data,
+                                       sizeof(*sc->stps_data), entries, 4);
 
     if (pb->eof_reached)
         return AVERROR_EOF;
@@ -2451,7 +2479,7 @@ static int mov_read_stss(MOVContext *c, AVIOContext *pb, MOVAtom atom)
 {
     AVStream *st;
     MOVStreamContext *sc;
-    unsigned int i, entries;
+    unsigned int entries;
 
     if (c->fc->nb_streams < 1)
         return 0;
@@ -2482,12 +2510,8 @@ static int mov_read_stss(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     if (!sc->keyframes)
         return AVERROR(ENOMEM);
 
-    for (i = 0; i < entries && !pb->eof_reached; i++) {
-        sc->keyframes[i] = avio_rb32(pb);
-        //av_log(c->fc, AV_LOG_TRACE, "keyframes[]=%d\n", sc->keyframes[i]);
-    }
-
-    sc->keyframe_count = i;
+    sc->keyframe_count = mov_read_be_table(pb, sc->keyframes,
+                                           sizeof(*sc->keyframes), entries, 4);
 
     if (pb->eof_reached)
         return AVERROR_EOF;
@@ -5274,15 +5298,59 @@ static int mov_change_extradata(MOVStreamContext *sc, AVPacket *pkt)
     return 0;
 }
 
+/**
+ * Move the current sample of a stream to its next keyframe, using only the
+ * index, so that the skipped samples are neither read nor seeked to.
+ */
+static int mov_skip_nonkey_samples(AVFormatContext *s, AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    int skipped = 0;
+
+    while (sc->current_sample < st->nb_index_entries &&
+           !(st->index_entries[sc->current_sample].flags & AVINDEX_KEYFRAME)) {
+        sc->current_sample++;
+        skipped++;
+        /* keep the ctts and stsc contexts in sync, like mov_read_packet() */
+        if (sc->ctts_data && sc->ctts_index < sc->ctts_count) {
+            sc->ctts_sample++;
+            if (sc->ctts_data[sc->ctts_index].count == sc->ctts_sample) {
+                sc->ctts_index++;
+                sc->ctts_sample = 0;
+            }
+        }
+        if (sc->stsc_data) {
+            sc->stsc_sample++;
+            if (sc->stsc_index < sc->stsc_count - 1 &&
+                mov_get_stsc_samples(sc, sc->stsc_index) == sc->stsc_sample) {
+                sc->stsc_index++;
+                sc->stsc_sample = 0;
+            }
+        }
+    }
+    if (skipped)
+        av_log(s, AV_LOG_TRACE, "%d nonkey samples from stream %d discarded due to AVDISCARD_NONKEY\n",
+               skipped, sc->ffindex);
+
+    if (skipped && sc->cenc.aes_ctr)
+        return mov_seek_auxiliary_info(s, sc);
+    return 0;
+}
+
 static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
 {
     MOVContext *mov = s->priv_data;
     MOVStreamContext *sc;
     AVIndexEntry *sample;
     AVStream *st = NULL;
-    int ret;
+    int i, ret;
     mov->fc = s;
  retry:
+    for (i = 0; i < s->nb_streams; i++) {
+        if (s->streams[i]->discard == AVDISCARD_NONKEY &&
+            (ret = mov_skip_nonkey_samples(s, s->streams[i])) < 0)
+            return ret;
+    }
     sample = mov_find_next_sample(s, &st);
     if (!sample || (mov->next_root_atom && sample->pos > mov->next_root_atom)) {
         if (!mov->next_root_atom)
@@ -5309,11 +5377,6 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
             return AVERROR_INVALIDDATA;
         }
 
-        if( st->discard == AVDISCARD_NONKEY && 0==(sample->flags & AVINDEX_KEYFRAME) ) {
-            av_log(mov->fc, AV_LOG_DEBUG, "Nonkey frame from stream %d discarded due to AVDISCARD_NONKEY\n", sc->ffindex);
-            goto retry;
-        }
-
         ret = av_get_packet(sc->pb, pkt, sample->size);
         if (ret < 0) {
             sc->current_sample -= should_retry(sc->pb, ret);
@@ -988,11 +988,24 @@ next_non_null:
     s->streams[pkt->stream_index]->last_in_packet_buffer =
         *next_point                                      = this_pktl;
 
+    s->internal->packet_buffer_size += this_pktl->pkt.size;
+    st->internal->nb_interleaved_packets++;
+    st->internal->max_interleaved_packets = FFMAX(st->internal->max_interleaved_packets,
+                                                  st->internal->nb_interleaved_packets);
+
     av_packet_unref(pkt);
 
     return 0;
 }
 
+void ff_interleave_remove_packet(AVFormatContext *s, AVPacketList *pktl)
+{
+    AVStream *st = s->streams[pktl->pkt.stream_index];
+
+    s->internal->packet_buffer_size -= pktl->pkt.size;
+    st->internal->nb_interleaved_packets--;
+}
+
 static int interleave_compare_dts(AVFormatContext *s, AVPacket *next,
                                   AVPacket *pkt)
 {
@@ -1075,6 +1088,16 @@ int ff_interleave_packet_per_dts(AVFormatContext *s, AVPacket *out,
         }
     }
 
+    if (s->max_interleave_size > 0 &&
+        !flush &&
+        s->internal->packet_buffer_size > s->max_interleave_size) {
+        av_log(s, AV_LOG_DEBUG,
+               "Size of the muxing queue is %"PRId64" > %"PRId64": "
+               "forcing output\n",
+               s->internal->packet_buffer_size, s->max_interleave_size);
+        flush = 1;
+    }
+
     if (stream_count && flush) {
         AVStream *st;
         pktl = s->internal->packet_buffer;
@@ -1087,6 +1110,7 @@ int ff_interleave_packet_per_dts(AVFormatContext *s, AVPacket *out,
 
         if (st->last_in_packet_buffer == pktl)
             st->last_in_packet_buffer = NULL;
+        ff_interleave_remove_packet(s, pktl);
         av_freep(&pktl);
 
         return 1;
@@ -1228,6 +1252,11 @@ int av_write_trailer(AVFormatContext *s)
     }
 
 fail:
+    for (i = 0; i < s->nb_streams; i++)
+        if (s->streams[i]->internal->max_interleaved_packets)
+            av_log(s, AV_LOG_VERBOSE, "Stream #%d: at most %d packets queued for interleaving\n",
+                   i, s->streams[i]->internal->max_interleaved_packets);
+
     if (s->internal->header_written && s->oformat->write_trailer) {
         if (!(s->oformat->flags & AVFMT_NOFILE) && s->pb)
             avio_write_marker(s->pb, AV_NOPTS_VALUE, AVIO_DATA_MARKER_TRAILER);
@@ -31,6 +31,7 @@
 
 #include "avformat.h"
 #include "avio_internal.h"
+#include "bgwriter.h"
 #include "internal.h"
 
 #include "libavutil/avassert.h"
@@ -123,6 +124,9 @@ typedef struct SegmentContext {
     int use_rename;
     char temp_list_filename[1024];
 
+    int async_close;       ///< finalize segments and lists in a background thread
+    FFBgWriter *bgwriter;
+
     SegmentListEntry cur_entry;
     SegmentListEntry *segment_list_entries;
     SegmentListEntry *segment_list_entries_end;
@@ -270,26 +274,18 @@ static int segment_start(AVFormatContext *s, int write_header)
     return 0;
 }
 
-static int segment_list_open(AVFormatContext *s)
+static void segment_list_print_header(AVFormatContext *s, AVIOContext *list_pb)
 {
     SegmentContext *seg = s->priv_data;
-    int ret;
-
-    snprintf(seg->temp_list_filename, sizeof(seg->temp_list_filename), seg->use_rename ? "%s.tmp" : "%s", seg->list);
-    ret = s->io_open(s, &seg->list_pb, seg->temp_list_filename, AVIO_FLAG_WRITE, NULL);
-    if (ret < 0) {
-        av_log(s, AV_LOG_ERROR, "Failed to open segment list '%s'\n", seg->list);
-        return ret;
-    }
 
     if (seg->list_type == LIST_TYPE_M3U8 && seg->segment_list_entries) {
         SegmentListEntry *entry;
         double max_duration = 0;
 
-        avio_printf(seg->list_pb, "#EXTM3U\n");
-        avio_printf(seg->list_pb, "#EXT-X-VERSION:3\n");
-        avio_printf(seg->list_pb, "#EXT-X-MEDIA-SEQUENCE:%d\n", seg->segment_list_entries->index);
-        avio_printf(seg->list_pb, "#EXT-X-ALLOW-CACHE:%s\n",
+        avio_printf(list_pb, "#EXTM3U\n");
+        avio_printf(list_pb, "#EXT-X-VERSION:3\n");
+        avio_printf(list_pb, "#EXT-X-MEDIA-SEQUENCE:%d\n", seg->segment_list_entries->index);
+        avio_printf(list_pb, "#EXT-X-ALLOW-CACHE:%s\n",
                     seg->list_flags & SEGMENT_LIST_FLAG_CACHE ? "YES" : "NO");
 
         av_log(s, AV_LOG_VERBOSE, "EXT-X-MEDIA-SEQUENCE:%d\n",
@@ -297,10 +293,23 @@ static int segment_list_open(AVFormatContext *s)
 
         for (entry = seg->segment_list_entries; entry; entry = entry->next)
             max_duration = FFMAX(max_duration, entry->end_time - entry->start_time);
-        avio_printf(seg->list_pb, "#EXT-X-TARGETDURATION:%"PRId64"\n", (int64_t)ceil(max_duration));
+        avio_printf(list_pb, "#EXT-X-TARGETDURATION:%"PRId64"\n", (int64_t)ceil(max_duration));
     } else if (seg->list_type == LIST_TYPE_FFCONCAT) {
-        avio_printf(seg->list_pb, "ffconcat version 1.0\n");
+        avio_printf(list_pb, "ffconcat version 1.0\n");
+    }
+}
+
+static int segment_list_open(AVFormatContext *s)
+{
+    SegmentContext *seg = s->priv_data;
+    int ret;
+
+    ret = s->io_open(s, &seg->list_pb, seg->temp_list_filename, AVIO_FLAG_WRITE, NULL);
+    if (ret < 0) {
+        av_log(s, AV_LOG_ERROR, "Failed to open segment list '%s'\n", seg->list);
+        return ret;
     }
+    segment_list_print_header(s, seg->list_pb);
 
     return ret;
 }
@@ -348,6 +357,7 @@ static int segment_end(AVFormatContext *s, int write_trailer, int is_last)
     AVTimecode tc;
     AVRational rate;
     AVDictionaryEntry *tcr;
+    AVIOContext *list_pb = NULL;
     char buf[AV_TIMECODE_STR_SIZE];
     int i;
     int err;
@@ -385,18 +395,19 @@ static int segment_end(AVFormatContext *s, int write_trailer, int is_last)
                 av_freep(&entry);
             }
 
-            if ((ret = segment_list_open(s)) < 0)
+            /* The list is built in memory and written out after the
+             * segment has been closed, possibly from the background writer. */
+            if ((ret = avio_open_dyn_buf(&list_pb)) < 0)
                 goto end;
+            segment_list_print_header(s, list_pb);
             for (entry = seg->segment_list_entries; entry; entry = entry->next)
-                segment_list_print_entry(seg->list_pb, seg->list_type, entry, s);
+                segment_list_print_entry(list_pb, seg->list_type, entry, s);
             if (seg->list_type == LIST_TYPE_M3U8 && is_last)
-                avio_printf(seg->list_pb, "#EXT-X-ENDLIST\n");
-            ff_format_io_close(s, &seg->list_pb);
-            if (seg->use_rename)
-                ff_rename(seg->temp_list_filename, seg->list, s);
+                avio_printf(list_pb, "#EXT-X-ENDLIST\n");
         } else {
-            segment_list_print_entry(seg->list_pb, seg->list_type, &seg->cur_entry, s);
-            avio_flush(seg->list_pb);
+            if ((ret = avio_open_dyn_buf(&list_pb)) < 0)
+                goto end;
+            segment_list_print_entry(list_pb, seg->list_type, &seg->cur_entry, s);
         }
     }
 
@@ -428,7 +439,19 @@ static int segment_end(AVFormatContext *s, int write_trailer, int is_last)
     }
 
 end:
-    ff_format_io_close(oc, &oc->pb);
+    err = ff_bgwriter_close(seg->bgwriter, &oc->pb);
+    if (ret >= 0)
+        ret = err;
+
+    if (list_pb) {
+        if (seg->list_size || seg->list_type == LIST_TYPE_M3U8)
+            err = ff_bgwriter_write_file(seg->bgwriter, &list_pb, seg->temp_list_filename,
+                                         NULL, seg->use_rename ? seg->list : NULL);
+        else
+            err = ff_bgwriter_append(seg->bgwriter, seg->list_pb, &list_pb);
+        if (ret >= 0)
+            ret = err;
+    }
 
     return ret;
 }
@@ -629,6 +652,7 @@ static int select_reference_stream(AVFormatContext *s)
 
 static void seg_free_context(SegmentContext *seg)
 {
+    ff_bgwriter_free(&seg->bgwriter);
     ff_format_io_close(seg->avf, &seg->list_pb);
     avformat_free_context(seg->avf);
     seg->avf = NULL;
@@ -700,18 +724,24 @@ static int seg_init(AVFormatContext *s)
             else if (av_match_ext(seg->list, "ffcat,ffconcat")) seg->list_type = LIST_TYPE_FFCONCAT;
             else                                      seg->list_type = LIST_TYPE_FLAT;
         }
+        if (seg->list_size || seg->list_type == LIST_TYPE_M3U8) {
+            const char *proto = avio_find_protocol_name(s->filename);
+            seg->use_rename = proto && !strcmp(proto, "file");
+        }
+        snprintf(seg->temp_list_filename, sizeof(seg->temp_list_filename),
+                 seg->use_rename ? "%s.tmp" : "%s", seg->list);
         if (!seg->list_size && seg->list_type != LIST_TYPE_M3U8) {
             if ((ret = segment_list_open(s)) < 0)
                 goto fail;
-        } else {
-            const char *proto = avio_find_protocol_name(s->filename);
-            seg->use_rename = proto && !strcmp(proto, "file");
         }
     }
 
     if (seg->list_type == LIST_TYPE_EXT)
         av_log(s, AV_LOG_WARNING, "'ext' list type option is deprecated in favor of 'csv'\n");
 
+    if ((ret = ff_bgwriter_alloc(&seg->bgwriter, s, seg->async_close)) < 0)
+        goto fail;
+
     if ((ret = select_reference_stream(s)) < 0)
         goto fail;
     av_log(s, AV_LOG_VERBOSE, "Selected stream id:%d type:%s\n",
@@ -919,7 +949,7 @@ static int seg_write_trailer(struct AVFormatContext *s)
     SegmentContext *seg = s->priv_data;
     AVFormatContext *oc = seg->avf;
     SegmentListEntry *cur, *next;
-    int ret = 0;
+    int ret = 0, err;
 
     if (!oc)
         goto fail;
@@ -935,6 +965,9 @@ static int seg_write_trailer(struct AVFormatContext *s)
         ret = segment_end(s, 1, 1);
     }
 fail:
+    err = ff_bgwriter_free(&seg->bgwriter);
+    if (ret >= 0)
+        ret = err;
     if (seg->list)
         ff_format_io_close(s, &seg->list_pb);
 
@@ -1000,6 +1033,7 @@ static const AVOption options[] = {
     { "reset_timestamps", "reset timestamps at the begin of each segment", OFFSET(reset_timestamps), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, E },
     { "initial_offset", "set initial timestamp offset", OFFSET(initial_offset), AV_OPT_TYPE_DURATION, {.i64 = 0}, -INT64_MAX, INT64_MAX, E },
     { "write_empty_segments", "allow writing empty 'filler' segments", OFFSET(write_empty), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, E },
+    { "async_close", "finalize segments and segment lists in a background thread", OFFSET(async_close), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, E },
     { NULL },
 };
 
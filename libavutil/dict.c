@@ -26,11 +26,91 @@
 #include "mem.h"
 #include "bprint.h"
 
+/* dictionaries with at least this many entries get a hash index */
+#define DICT_INDEX_MIN 16
+
+typedef struct DictEntryInfo {
+    unsigned hash;              ///< case insensitive hash of the key
+    int static_key;             ///< the key was set with AV_DICT_STATIC_KEY
+} DictEntryInfo;
+
 struct AVDictionary {
     int count;
     AVDictionaryEntry *elems;
+    DictEntryInfo *info;
+    unsigned size;              ///< allocated elements in elems and info
+
+    /**
+     * Open addressing hash table of element index + 1 by key hash, 0 for
+     * empty slots and -1 for removed elements, or NULL if not built.
+     */
+    int *index;
+    unsigned index_mask;
+    unsigned index_used;        ///< non empty slots
 };
 
+static unsigned dict_hash(const char *key)
+{
+    uint32_t h = 2166136261U;
+
+    while (*key)
+        h = (h ^ av_toupper(*key++)) * 16777619U;
+    return h;
+}
+
+static int dict_match(const char *s, const char *key, int flags)
+{
+    unsigned j;
+
+    if (flags & AV_DICT_MATCH_CASE)
+        for (j = 0; s[j] == key[j] && key[j]; j++)
+            ;
+    else
+        for (j = 0; av_toupper(s[j]) == av_toupper(key[j]) && key[j]; j++)
+            ;
+    if (key[j])
+        return 0;
+    if (s[j] && !(flags & AV_DICT_IGNORE_SUFFIX))
+        return 0;
+    return 1;
+}
+
+static void index_insert(AVDictionary *m, int i)
+{
+    unsigned slot = m->info[i].hash & m->index_mask;
+
+    while (m->index[slot] > 0)
+        slot = (slot + 1) & m->index_mask;
+    m->index_used += !m->index[slot];
+    m->index[slot] = i + 1;
+}
+
+static int *index_find(AVDictionary *m, int i)
+{
+    unsigned slot = m->info[i].hash & m->index_mask;
+
+    while (m->index[slot] != i + 1)
+        slot = (slot + 1) & m->index_mask;
+    return &m->index[slot];
+}
+
+static void index_build(AVDictionary *m)
+{
+    unsigned size = 2 * DICT_INDEX_MIN;
+    int i;
+
+    av_freep(&m->index);
+    while (size < 2 * m->count)
+        size <<= 1;
+    m->index = av_mallocz_array(size, sizeof(*m->index));
+    if (!m->index)
+        return;
+    m->index_mask = size - 1;
+    m->index_used = 0;
+    for (i = 0; i < m->count; i++)
+        index_insert(m, i);
+}
+
 int av_dict_count(const AVDictionary *m)
 {
     return m ? m->count : 0;
@@ -39,7 +119,7 @@ int av_dict_count(const AVDictionary *m)
 AVDictionaryEntry *av_dict_get(const AVDictionary *m, const char *key,
                                const AVDictionaryEntry *prev, int flags)
 {
-    unsigned int i, j;
+    unsigned int i, hash;
 
     if (!m)
         return NULL;
@@ -49,23 +129,79 @@ AVDictionaryEntry *av_dict_get(const AVDictionary *m, const char *key,
     else
         i = 0;
 
-    for (; i < m->count; i++) {
-        const char *s = m->elems[i].key;
-        if (flags & AV_DICT_MATCH_CASE)
-            for (j = 0; s[j] == key[j] && key[j]; j++)
-                ;
-        else
-            for (j = 0; av_toupper(s[j]) == av_toupper(key[j]) && key[j]; j++)
-                ;
-        if (key[j])
-            continue;
-        if (s[j] && !(flags & AV_DICT_IGNORE_SUFFIX))
-            continue;
-        return &m->elems[i];
+    if (flags & AV_DICT_IGNORE_SUFFIX) {
+        for (; i < m->count; i++)
+            if (dict_match(m->elems[i].key, key, flags))
+                return &m->elems[i];
+        return NULL;
+    }
+
+    hash = dict_hash(key);
+    if (m->index) {
+        /* the first match in element order is returned, so the whole
+         * collision chain has to be walked */
+        unsigned slot = hash & m->index_mask, best = m->count;
+        int idx;
+
+        while ((idx = m->index[slot])) {
+            idx--;
+            if (idx >= (int)i && idx < best && m->info[idx].hash == hash &&
+                dict_match(m->elems[idx].key, key, flags))
+                best = idx;
+            slot = (slot + 1) & m->index_mask;
+        }
+        return best < m->count ? &m->elems[best] : NULL;
     }
+
+    for (; i < m->count; i++)
+        if (m->info[i].hash == hash && dict_match(m->elems[i].key, key, flags))
+            return &m->elems[i];
     return NULL;
 }
 
+static int dict_grow(AVDictionary *m)
+{
+    unsigned size = FFMAX(2 * m->size, 4);
+    void *tmp;
+
+    if (m->count < m->size)
+        return 0;
+    if (size > INT_MAX / sizeof(*m->elems))
+        return AVERROR(ENOMEM);
+    tmp = av_realloc_array(m->elems, size, sizeof(*m->elems));
+    if (!tmp)
+        return AVERROR(ENOMEM);
+    m->elems = tmp;
+    tmp = av_realloc_array(m->info, size, sizeof(*m->info));
+    if (!tmp)
+        return AVERROR(ENOMEM);
+    m->info = tmp;
+    m->size = size;
+    return 0;
+}
+
+static void dict_free_key(char *key, int flags)
+{
+    if (!(flags & AV_DICT_STATIC_KEY))
+        av_free(key);
+}
+
+static void dict_remove(AVDictionary *m, AVDictionaryEntry *tag)
+{
+    int i = tag - m->elems, last = m->count - 1;
+
+    if (!m->info[i].static_key)
+        av_free(tag->key);
+    if (m->index) {
+        *index_find(m, i) = -1;
+        if (i != last)
+            *index_find(m, last) = i + 1;
+    }
+    m->elems[i] = m->elems[last];
+    m->info[i]  = m->info[last];
+    m->count--;
+}
+
 int av_dict_set(AVDictionary **pm, const char *key, const char *value,
                 int flags)
 {
@@ -76,7 +212,7 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
     if (!(flags & AV_DICT_MULTIKEY)) {
         tag = av_dict_get(m, key, NULL, flags);
     }
-    if (flags & AV_DICT_DONT_STRDUP_KEY)
+    if (flags & (AV_DICT_DONT_STRDUP_KEY | AV_DICT_STATIC_KEY))
         copy_key = (void *)key;
     else
         copy_key = av_strdup(key);
@@ -91,7 +227,7 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
 
     if (tag) {
         if (flags & AV_DICT_DONT_OVERWRITE) {
-            av_free(copy_key);
+            dict_free_key(copy_key, flags);
             av_free(copy_value);
             return 0;
         }
@@ -99,18 +235,16 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
             oldval = tag->value;
         else
             av_free(tag->value);
-        av_free(tag->key);
-        *tag = m->elems[--m->count];
+        dict_remove(m, tag);
     } else if (copy_value) {
-        AVDictionaryEntry *tmp = av_realloc(m->elems,
-                                            (m->count + 1) * sizeof(*m->elems));
-        if (!tmp)
+        if (dict_grow(m) < 0)
             goto err_out;
-        m->elems = tmp;
     }
     if (copy_value) {
         m->elems[m->count].key = copy_key;
         m->elems[m->count].value = copy_value;
+        m->info[m->count].hash = dict_hash(copy_key);
+        m->info[m->count].static_key = !!(flags & AV_DICT_STATIC_KEY);
         if (oldval && flags & AV_DICT_APPEND) {
             size_t len = strlen(oldval) + strlen(copy_value) + 1;
             char *newval = av_mallocz(len);
@@ -123,11 +257,17 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
             av_freep(&copy_value);
         }
         m->count++;
+        if (m->index && m->index_used < m->index_mask - m->index_mask / 4)
+            index_insert(m, m->count - 1);
+        else if (m->index || m->count >= DICT_INDEX_MIN)
+            index_build(m);
     } else {
-        av_freep(&copy_key);
+        dict_free_key(copy_key, flags);
     }
     if (!m->count) {
         av_freep(&m->elems);
+        av_freep(&m->info);
+        av_freep(&m->index);
         av_freep(pm);
     }
 
@@ -136,9 +276,11 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
 err_out:
     if (m && !m->count) {
         av_freep(&m->elems);
+        av_freep(&m->info);
+        av_freep(&m->index);
         av_freep(pm);
     }
-    av_free(copy_key);
+    dict_free_key(copy_key, flags);
     av_free(copy_value);
     return AVERROR(ENOMEM);
 }
@@ -205,10 +347,13 @@ void av_dict_free(AVDictionary **pm)
 
     if (m) {
         while (m->count--) {
-            av_freep(&m->elems[m->count].key);
+            if (!m->info[m->count].static_key)
+                av_freep(&m->elems[m->count].key);
             av_freep(&m->elems[m->count].value);
         }
         av_freep(&m->elems);
+        av_freep(&m->info);
+        av_freep(&m->index);
     }
     av_freep(pm);
 }
@@ -218,7 +363,8 @@ int av_dict_copy(AVDictionary **dst, const AVDictionary *src, int flags)
     AVDictionaryEntry *t = NULL;
 
     while ((t = av_dict_get(src, "", t, AV_DICT_IGNORE_SUFFIX))) {
-        int ret = av_dict_set(dst, t->key, t->value, flags);
+        int key_flags = src->info[t - src->elems].static_key ? AV_DICT_STATIC_KEY : 0;
+        int ret = av_dict_set(dst, t->key, t->value, flags | key_flags);
         if (ret < 0)
             return ret;
     }
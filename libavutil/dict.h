@@ -77,6 +77,9 @@
 #define AV_DICT_APPEND         32   /**< If the entry already exists, append to it.  Note that no
                                       delimiter is added, the strings are simply concatenated. */
 #define AV_DICT_MULTIKEY       64   /**< Allow to store several equal keys in the dictionary */
+#define AV_DICT_STATIC_KEY    128   /**< The key is a constant string, e.g. a string literal, which
+                                         outlives the dictionary. It is neither duplicated nor freed,
+                                         and stays shared when the entry is copied with av_dict_copy(). */
 
 typedef struct AVDictionaryEntry {
     char *key;
@@ -115,7 +118,8 @@ int av_dict_count(const AVDictionary *m);
  * Set the given entry in *pm, overwriting an existing entry.
  *
  * Note: If AV_DICT_DONT_STRDUP_KEY or AV_DICT_DONT_STRDUP_VAL is set,
- * these arguments will be freed on error.
+ * these arguments will be freed on error. AV_DICT_STATIC_KEY takes precedence
+ * over AV_DICT_DONT_STRDUP_KEY.
  *
  * Warning: Adding a new entry to a dictionary invalidates all existing entries
  * previously returned with av_dict_get.
@@ -655,6 +655,53 @@ static int verify_expr(AVExpr *e)
     }
 }
 
+/**
+ * Replace the subtrees of e which do not depend on the constants, the
+ * variables, the user functions or the state of the evaluator by their
+ * value, so that they are not evaluated again on each av_expr_eval().
+ * @return 1 if e itself was reduced to a value, 0 otherwise
+ */
+static int fold_expr(Parser *p, AVExpr *e)
+{
+    int i, fold = 1;
+
+    for (i = 0; i < 3; i++)
+        if (e->param[i] && !fold_expr(p, e->param[i]))
+            fold = 0;
+
+    switch (e->type) {
+    case e_value:
+        return 1;
+    case e_const:
+    case e_func1:
+    case e_func2:
+    case e_ld:
+    case e_st:
+    case e_random:
+    case e_print:
+    case e_while:
+    case e_taylor:
+    case e_root:
+        return 0;
+    case e_func0:
+        if (e->a.func0 == etime)
+            return 0;
+        break;
+    default:
+        break;
+    }
+    if (!fold)
+        return 0;
+
+    e->value = eval_expr(p, e);
+    e->type  = e_value;
+    for (i = 0; i < 3; i++) {
+        av_expr_free(e->param[i]);
+        e->param[i] = NULL;
+    }
+    return 1;
+}
+
 int av_expr_parse(AVExpr **expr, const char *s,
                   const char * const *const_names,
                   const char * const *func1_names, double (* const *funcs1)(void *, double),
@@ -697,6 +744,7 @@ int av_expr_parse(AVExpr **expr, const char *s,
         ret = AVERROR(EINVAL);
         goto end;
     }
+    fold_expr(&p, e);
     e->var= av_mallocz(sizeof(double) *VARS);
     if (!e->var) {
         ret = AVERROR(ENOMEM);
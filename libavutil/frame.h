@@ -722,6 +722,26 @@ AVFrameSideData *av_frame_new_side_data(AVFrame *frame,
                                         enum AVFrameSideDataType type,
                                         int size);
 
+/**
+ * Add a new side data to a frame from an existing AVBufferRef. This allows
+ * side data to be allocated from an AVBufferPool, so that its memory is
+ * reused from frame to frame.
+ *
+ * The side data size is initialized to the size of the buffer, the caller
+ * may shrink it afterwards if only the start of the buffer is used.
+ *
+ * @param frame a frame to which the side data should be added
+ * @param type  type of the added side data
+ * @param buf   an AVBufferRef to add as side data. The ownership of the
+ *              reference is transferred to the frame.
+ *
+ * @return newly added side data on success, NULL on error. On failure the
+ *         frame is unchanged and the AVBufferRef remains owned by the caller.
+ */
+AVFrameSideData *av_frame_new_side_data_from_buf(AVFrame *frame,
+                                                 enum AVFrameSideDataType type,
+                                                 AVBufferRef *buf);
+
 /**
  * @return a pointer to the side data of a given type on success, NULL if there
  * is no side data with such type in this frame.
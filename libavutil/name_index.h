@@ -0,0 +1,109 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Lock-free hash index over registered components (codecs, formats,
+ * filters), used to avoid walking the registration lists on lookups.
+ *
+ * The index is an open addressing hash table of entry pointers, filled at
+ * registration time. Entries are never removed, so a lookup needs no lock:
+ * it walks the slots starting at the home slot of the key up to the first
+ * empty slot, and the caller checks every candidate with its usual
+ * comparison. Candidates for a given key are returned in registration order.
+ *
+ * If the table runs full, overflow is set and lookups must fall back to
+ * walking the list.
+ */
+
+#ifndef AVUTIL_NAME_INDEX_H
+#define AVUTIL_NAME_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "atomic.h"
+#include "avstring.h"
+
+typedef struct FFNameIndex {
+    void * volatile *entries;
+    unsigned mask;              ///< number of slots - 1, slots are a power of 2
+    volatile int overflow;
+} FFNameIndex;
+
+/**
+ * Define a static index with nb_slots slots, nb_slots must be a power of 2.
+ */
+#define FF_NAME_INDEX(name, nb_slots)                                   \
+    static void * volatile name ## _entries[nb_slots];                  \
+    static FFNameIndex name = { name ## _entries, (nb_slots) - 1 }
+
+/**
+ * Case insensitive hash of the first len characters of name.
+ */
+static inline unsigned ff_name_index_hash(const char *name, size_t len)
+{
+    uint32_t h = 2166136261U;
+
+    while (len-- && *name)
+        h = (h ^ av_tolower(*name++)) * 16777619U;
+    return h;
+}
+
+static inline unsigned ff_name_index_hash_int(unsigned v)
+{
+    return v * 2654435761U;
+}
+
+static inline void ff_name_index_add(FFNameIndex *idx, unsigned hash, void *entry)
+{
+    unsigned i;
+
+    for (i = 0; i <= idx->mask; i++) {
+        void * volatile *slot = &idx->entries[(hash + i) & idx->mask];
+        if (!*slot && !avpriv_atomic_ptr_cas(slot, NULL, entry))
+            return;
+    }
+    idx->overflow = 1;
+}
+
+/**
+ * Get the n-th candidate for hash, NULL once there are no more.
+ */
+static inline void *ff_name_index_get(const FFNameIndex *idx, unsigned hash, unsigned n)
+{
+    if (n > idx->mask)
+        return NULL;
+    return idx->entries[(hash + n) & idx->mask];
+}
+
+/**
+ * Add one entry per element of a comma separated list of names.
+ */
+static inline void ff_name_index_add_list(FFNameIndex *idx, const char *names, void *entry)
+{
+    while (names && *names) {
+        size_t len = strcspn(names, ",");
+        if (len)
+            ff_name_index_add(idx, ff_name_index_hash(names, len), entry);
+        names += len + (names[len] == ',');
+    }
+}
+
+#endif /* AVUTIL_NAME_INDEX_H */
@@ -48,9 +48,11 @@ static void test_separators(const AVDictionary *m, const char pair, const char v
 
 int main(void)
 {
-    AVDictionary *dict = NULL;
+    AVDictionary *dict = NULL, *copy = NULL;
     AVDictionaryEntry *e;
     char *buffer = NULL;
+    char key[16];
+    int i;
 
     printf("Testing av_dict_get_string() and av_dict_parse_string()\n");
     av_dict_get_string(dict, &buffer, '=', ',');
@@ -129,5 +131,34 @@ int main(void)
     printf("%s\n", e->value);
     av_dict_free(&dict);
 
+    printf("\nTesting hashed lookups\n");
+    for (i = 0; i < 100; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        av_dict_set_int(&dict, key, i, 0);
+    }
+    for (i = 0; i < 100; i += 3) {
+        snprintf(key, sizeof(key), "KEY%d", i);
+        av_dict_set(&dict, key, i % 2 ? NULL : "even", 0);
+    }
+    av_dict_set(&dict, "Key10", "case", AV_DICT_MATCH_CASE);
+    av_dict_set(&dict, "key7", "multi", AV_DICT_MULTIKEY);
+    av_dict_set(&dict, "static", "static", AV_DICT_STATIC_KEY);
+    printf("%d entries\n", av_dict_count(dict));
+    for (i = 0; i < 12; i++) {
+        snprintf(key, sizeof(key), "kEy%d", i);
+        e = NULL;
+        while ((e = av_dict_get(dict, key, e, 0)))
+            printf("%s %s   ", e->key, e->value);
+        printf("\n");
+    }
+    e = av_dict_get(dict, "Key10", NULL, AV_DICT_MATCH_CASE);
+    printf("%s %s\n", e->key, e->value);
+    av_dict_copy(&copy, dict, 0);
+    av_dict_free(&dict);
+    printf("%d entries after copy\n", av_dict_count(copy));
+    e = av_dict_get(copy, "static", NULL, 0);
+    printf("%s %s\n", e->key, e->value);
+    av_dict_free(&copy);
+
     return 0;
 }
@@ -0,0 +1,107 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Single producer, single consumer throughput of the message queue:
+ *   libavutil/tests/threadmessage [nb_msgs [queue_size [batch_size]]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "libavutil/common.h"
+#include "libavutil/thread.h"
+#include "libavutil/threadmessage.h"
+#include "libavutil/time.h"
+
+#define MAX_BATCH 256
+
+static AVThreadMessageQueue *queue;
+static int nb_msgs, batch_size;
+
+static void *sender_thread(void *arg)
+{
+    int64_t msgs[MAX_BATCH];
+    int i, j, ret;
+
+    for (i = 0; i < nb_msgs; i += ret) {
+        int n = FFMIN(batch_size, nb_msgs - i);
+
+        for (j = 0; j < n; j++)
+            msgs[j] = i + j;
+        if (batch_size == 1)
+            ret = av_thread_message_queue_send(queue, msgs, 0) < 0 ? -1 : 1;
+        else
+            ret = av_thread_message_queue_send_batch(queue, msgs, n, 0);
+        if (ret < 0)
+            break;
+    }
+    av_thread_message_queue_set_err_recv(queue, AVERROR_EOF);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int64_t msgs[MAX_BATCH], expected = 0, t;
+    int queue_size, ret = 0, i;
+    pthread_t sender;
+
+    nb_msgs    = argc > 1 ? atoi(argv[1]) : 1000000;
+    queue_size = argc > 2 ? atoi(argv[2]) : 64;
+    batch_size = argc > 3 ? av_clip(atoi(argv[3]), 1, MAX_BATCH) : 1;
+
+    if (nb_msgs <= 0 || queue_size <= 0) {
+        fprintf(stderr, "usage: %s [nb_msgs [queue_size [batch_size]]]\n", argv[0]);
+        return 1;
+    }
+    if (av_thread_message_queue_alloc(&queue, queue_size, sizeof(*msgs)) < 0)
+        return 1;
+
+    t = av_gettime_relative();
+    if (pthread_create(&sender, NULL, sender_thread, NULL)) {
+        av_thread_message_queue_free(&queue);
+        return 1;
+    }
+    for (;;) {
+        if (batch_size == 1)
+            ret = av_thread_message_queue_recv(queue, msgs, 0) < 0 ? -1 : 1;
+        else
+            ret = av_thread_message_queue_recv_batch(queue, msgs, batch_size, 0);
+        if (ret < 0)
+            break;
+        for (i = 0; i < ret; i++) {
+            if (msgs[i] != expected) {
+                fprintf(stderr, "got message %"PRId64", expected %"PRId64"\n",
+                        msgs[i], expected);
+                av_thread_message_queue_set_err_send(queue, AVERROR(EINVAL));
+                break;
+            }
+            expected++;
+        }
+        if (i < ret)
+            break;
+    }
+    pthread_join(sender, NULL);
+    t = av_gettime_relative() - t;
+    av_thread_message_queue_free(&queue);
+
+    printf("%"PRId64" messages, queue size %d, batch size %d: %.1f ns/msg\n",
+           expected, queue_size, batch_size,
+           expected ? 1000.0 * t / expected : 0);
+    return expected != nb_msgs;
+}
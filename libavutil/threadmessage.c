@@ -18,20 +18,52 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
-#include "fifo.h"
+#include <string.h>
+
+#include "atomic.h"
+#include "common.h"
+#include "mem.h"
 #include "threadmessage.h"
 #include "thread.h"
 
+/*
+ * The messages are stored in a ring of elsize byte slots. tail counts the
+ * messages ever sent and is only written by the sender holding lock_send,
+ * head counts the messages ever received and is only written by the receiver
+ * holding lock_recv, so a sender and a receiver never wait for each other
+ * unless the queue is full or empty. With a single sender and a single
+ * receiver, both locks are uncontended.
+ *
+ * Only then does a thread park on the cond_send or cond_recv condition, after
+ * announcing it in send_waiting or recv_waiting. The other side checks these
+ * counters after publishing head or tail, if the queue was empty (resp. full)
+ * before the update, and only then takes lock to wake it up. All accesses to
+ * head, tail and the counters are sequentially consistent, so either the
+ * parking thread sees the update or the updating thread sees the waiter.
+ */
 struct AVThreadMessageQueue {
 #if HAVE_THREADS
-    AVFifoBuffer *fifo;
+    uint8_t *buf;
+    unsigned elsize;
+    unsigned nelem;
+    unsigned mask;              ///< number of slots - 1
+    void (*free_func)(void *msg);
+
+    pthread_mutex_t lock_send;
+    volatile int tail;
+    volatile int send_waiting;
+    volatile int err_send;
+    /* keep the sender and receiver fields on different cache lines */
+    uint8_t padding[64];
+
+    pthread_mutex_t lock_recv;
+    volatile int head;
+    volatile int recv_waiting;
+    volatile int err_recv;
+
     pthread_mutex_t lock;
     pthread_cond_t cond_recv;
     pthread_cond_t cond_send;
-    int err_send;
-    int err_recv;
-    unsigned elsize;
-    void (*free_func)(void *msg);
 #else
     int dummy;
 #endif
@@ -43,37 +75,49 @@ int av_thread_message_queue_alloc(AVThreadMessageQueue **mq,
 {
 #if HAVE_THREADS
     AVThreadMessageQueue *rmq;
+    unsigned size = 1;
     int ret = 0;
 
-    if (nelem > INT_MAX / elsize)
+    if (!elsize || nelem > INT_MAX / elsize)
+        return AVERROR(EINVAL);
+    while (size < nelem)
+        size <<= 1;
+    if (size > INT_MAX / elsize)
         return AVERROR(EINVAL);
     if (!(rmq = av_mallocz(sizeof(*rmq))))
         return AVERROR(ENOMEM);
-    if ((ret = pthread_mutex_init(&rmq->lock, NULL))) {
-        av_free(rmq);
-        return AVERROR(ret);
-    }
-    if ((ret = pthread_cond_init(&rmq->cond_recv, NULL))) {
-        pthread_mutex_destroy(&rmq->lock);
-        av_free(rmq);
-        return AVERROR(ret);
-    }
-    if ((ret = pthread_cond_init(&rmq->cond_send, NULL))) {
-        pthread_cond_destroy(&rmq->cond_recv);
-        pthread_mutex_destroy(&rmq->lock);
+    if (!(rmq->buf = av_malloc(size * elsize))) {
         av_free(rmq);
-        return AVERROR(ret);
-    }
-    if (!(rmq->fifo = av_fifo_alloc(elsize * nelem))) {
-        pthread_cond_destroy(&rmq->cond_send);
-        pthread_cond_destroy(&rmq->cond_recv);
-        pthread_mutex_destroy(&rmq->lock);
-        av_free(rmq);
-        return AVERROR(ret);
+        return AVERROR(ENOMEM);
     }
+    if ((ret = pthread_mutex_init(&rmq->lock, NULL)))
+        goto fail_buf;
+    if ((ret = pthread_mutex_init(&rmq->lock_send, NULL)))
+        goto fail_lock;
+    if ((ret = pthread_mutex_init(&rmq->lock_recv, NULL)))
+        goto fail_lock_send;
+    if ((ret = pthread_cond_init(&rmq->cond_recv, NULL)))
+        goto fail_lock_recv;
+    if ((ret = pthread_cond_init(&rmq->cond_send, NULL)))
+        goto fail_cond_recv;
     rmq->elsize = elsize;
+    rmq->nelem  = nelem;
+    rmq->mask   = size - 1;
     *mq = rmq;
     return 0;
+
+fail_cond_recv:
+    pthread_cond_destroy(&rmq->cond_recv);
+fail_lock_recv:
+    pthread_mutex_destroy(&rmq->lock_recv);
+fail_lock_send:
+    pthread_mutex_destroy(&rmq->lock_send);
+fail_lock:
+    pthread_mutex_destroy(&rmq->lock);
+fail_buf:
+    av_free(rmq->buf);
+    av_free(rmq);
+    return AVERROR(ret);
 #else
     *mq = NULL;
     return AVERROR(ENOSYS);
@@ -93,9 +137,11 @@ void av_thread_message_queue_free(AVThreadMessageQueue **mq)
 #if HAVE_THREADS
     if (*mq) {
         av_thread_message_flush(*mq);
-        av_fifo_freep(&(*mq)->fifo);
+        av_freep(&(*mq)->buf);
         pthread_cond_destroy(&(*mq)->cond_send);
         pthread_cond_destroy(&(*mq)->cond_recv);
+        pthread_mutex_destroy(&(*mq)->lock_recv);
+        pthread_mutex_destroy(&(*mq)->lock_send);
         pthread_mutex_destroy(&(*mq)->lock);
         av_freep(mq);
     }
@@ -104,38 +150,110 @@ void av_thread_message_queue_free(AVThreadMessageQueue **mq)
 
 #if HAVE_THREADS
 
-static int av_thread_message_queue_send_locked(AVThreadMessageQueue *mq,
-                                               void *msg,
-                                               unsigned flags)
+static unsigned queue_used(AVThreadMessageQueue *mq)
+{
+    return (unsigned)avpriv_atomic_int_get(&mq->tail) -
+           (unsigned)avpriv_atomic_int_get(&mq->head);
+}
+
+static void queue_wake(AVThreadMessageQueue *mq, volatile int *waiting,
+                       pthread_cond_t *cond)
 {
-    while (!mq->err_send && av_fifo_space(mq->fifo) < mq->elsize) {
-        if ((flags & AV_THREAD_MESSAGE_NONBLOCK))
-            return AVERROR(EAGAIN);
-        pthread_cond_wait(&mq->cond_send, &mq->lock);
+    if (avpriv_atomic_int_get(waiting)) {
+        pthread_mutex_lock(&mq->lock);
+        pthread_cond_broadcast(cond);
+        pthread_mutex_unlock(&mq->lock);
     }
-    if (mq->err_send)
-        return mq->err_send;
-    av_fifo_generic_write(mq->fifo, msg, mq->elsize, NULL);
-    /* one message is sent, signal one receiver */
-    pthread_cond_signal(&mq->cond_recv);
-    return 0;
 }
 
-static int av_thread_message_queue_recv_locked(AVThreadMessageQueue *mq,
-                                               void *msg,
-                                               unsigned flags)
+static int queue_send(AVThreadMessageQueue *mq, const uint8_t *msgs,
+                      int nb_msgs, unsigned flags)
 {
-    while (!mq->err_recv && av_fifo_size(mq->fifo) < mq->elsize) {
-        if ((flags & AV_THREAD_MESSAGE_NONBLOCK))
-            return AVERROR(EAGAIN);
-        pthread_cond_wait(&mq->cond_recv, &mq->lock);
+    int sent = 0, ret = 0;
+
+    pthread_mutex_lock(&mq->lock_send);
+    while (sent < nb_msgs) {
+        unsigned tail = mq->tail;
+        unsigned space, i;
+
+        if ((ret = avpriv_atomic_int_get(&mq->err_send)))
+            break;
+
+        space = mq->nelem - (tail - (unsigned)avpriv_atomic_int_get(&mq->head));
+        if (!space) {
+            if ((flags & AV_THREAD_MESSAGE_NONBLOCK)) {
+                ret = AVERROR(EAGAIN);
+                break;
+            }
+            /* let other senders and the flushing threads in while we wait */
+            pthread_mutex_unlock(&mq->lock_send);
+            pthread_mutex_lock(&mq->lock);
+            avpriv_atomic_int_add_and_fetch(&mq->send_waiting, 1);
+            while (!avpriv_atomic_int_get(&mq->err_send) && queue_used(mq) >= mq->nelem)
+                pthread_cond_wait(&mq->cond_send, &mq->lock);
+            avpriv_atomic_int_add_and_fetch(&mq->send_waiting, -1);
+            pthread_mutex_unlock(&mq->lock);
+            pthread_mutex_lock(&mq->lock_send);
+            continue;
+        }
+
+        space = FFMIN(space, nb_msgs - sent);
+        for (i = 0; i < space; i++)
+            memcpy(mq->buf + ((tail + i) & mq->mask) * mq->elsize,
+                   msgs + (sent + i) * mq->elsize, mq->elsize);
+        avpriv_atomic_int_set(&mq->tail, tail + space);
+        sent += space;
+        /* receivers only park on an empty queue */
+        if ((int)((unsigned)avpriv_atomic_int_get(&mq->head) - tail) >= 0)
+            queue_wake(mq, &mq->recv_waiting, &mq->cond_recv);
     }
-    if (av_fifo_size(mq->fifo) < mq->elsize)
-        return mq->err_recv;
-    av_fifo_generic_read(mq->fifo, msg, mq->elsize, NULL);
-    /* one message space appeared, signal one sender */
-    pthread_cond_signal(&mq->cond_send);
-    return 0;
+    pthread_mutex_unlock(&mq->lock_send);
+
+    return sent ? sent : ret;
+}
+
+static int queue_recv(AVThreadMessageQueue *mq, uint8_t *msgs,
+                      int nb_msgs, unsigned flags)
+{
+    int received = 0, ret = 0;
+
+    pthread_mutex_lock(&mq->lock_recv);
+    while (!received) {
+        unsigned head = mq->head;
+        unsigned used, i;
+
+        used = (unsigned)avpriv_atomic_int_get(&mq->tail) - head;
+        if (!used) {
+            if ((ret = avpriv_atomic_int_get(&mq->err_recv)))
+                break;
+            if ((flags & AV_THREAD_MESSAGE_NONBLOCK)) {
+                ret = AVERROR(EAGAIN);
+                break;
+            }
+            pthread_mutex_unlock(&mq->lock_recv);
+            pthread_mutex_lock(&mq->lock);
+            avpriv_atomic_int_add_and_fetch(&mq->recv_waiting, 1);
+            while (!avpriv_atomic_int_get(&mq->err_recv) && !queue_used(mq))
+                pthread_cond_wait(&mq->cond_recv, &mq->lock);
+            avpriv_atomic_int_add_and_fetch(&mq->recv_waiting, -1);
+            pthread_mutex_unlock(&mq->lock);
+            pthread_mutex_lock(&mq->lock_recv);
+            continue;
+        }
+
+        used = FFMIN(used, nb_msgs);
+        for (i = 0; i < used; i++)
+            memcpy(msgs + i * mq->elsize,
+                   mq->buf + ((head + i) & mq->mask) * mq->elsize, mq->elsize);
+        avpriv_atomic_int_set(&mq->head, head + used);
+        received = used;
+        /* senders only park on a full queue */
+        if ((unsigned)avpriv_atomic_int_get(&mq->tail) - head >= mq->nelem)
+            queue_wake(mq, &mq->send_waiting, &mq->cond_send);
+    }
+    pthread_mutex_unlock(&mq->lock_recv);
+
+    return received ? received : ret;
 }
 
 #endif /* HAVE_THREADS */
@@ -145,12 +263,8 @@ int av_thread_message_queue_send(AVThreadMessageQueue *mq,
                                  unsigned flags)
 {
 #if HAVE_THREADS
-    int ret;
-
-    pthread_mutex_lock(&mq->lock);
-    ret = av_thread_message_queue_send_locked(mq, msg, flags);
-    pthread_mutex_unlock(&mq->lock);
-    return ret;
+    int ret = queue_send(mq, msg, 1, flags);
+    return FFMIN(ret, 0);
 #else
     return AVERROR(ENOSYS);
 #endif /* HAVE_THREADS */
@@ -161,12 +275,34 @@ int av_thread_message_queue_recv(AVThreadMessageQueue *mq,
                                  unsigned flags)
 {
 #if HAVE_THREADS
-    int ret;
+    int ret = queue_recv(mq, msg, 1, flags);
+    return FFMIN(ret, 0);
+#else
+    return AVERROR(ENOSYS);
+#endif /* HAVE_THREADS */
+}
 
-    pthread_mutex_lock(&mq->lock);
-    ret = av_thread_message_queue_recv_locked(mq, msg, flags);
-    pthread_mutex_unlock(&mq->lock);
-    return ret;
+int av_thread_message_queue_send_batch(AVThreadMessageQueue *mq,
+                                       void *msgs, int nb_msgs,
+                                       unsigned flags)
+{
+#if HAVE_THREADS
+    if (nb_msgs <= 0)
+        return AVERROR(EINVAL);
+    return queue_send(mq, msgs, nb_msgs, flags);
+#else
+    return AVERROR(ENOSYS);
+#endif /* HAVE_THREADS */
+}
+
+int av_thread_message_queue_recv_batch(AVThreadMessageQueue *mq,
+                                       void *msgs, int nb_msgs,
+                                       unsigned flags)
+{
+#if HAVE_THREADS
+    if (nb_msgs <= 0)
+        return AVERROR(EINVAL);
+    return queue_recv(mq, msgs, nb_msgs, flags);
 #else
     return AVERROR(ENOSYS);
 #endif /* HAVE_THREADS */
@@ -177,7 +313,7 @@ void av_thread_message_queue_set_err_send(AVThreadMessageQueue *mq,
 {
 #if HAVE_THREADS
     pthread_mutex_lock(&mq->lock);
-    mq->err_send = err;
+    avpriv_atomic_int_set(&mq->err_send, err);
     pthread_cond_broadcast(&mq->cond_send);
     pthread_mutex_unlock(&mq->lock);
 #endif /* HAVE_THREADS */
@@ -188,35 +324,27 @@ void av_thread_message_queue_set_err_recv(AVThreadMessageQueue *mq,
 {
 #if HAVE_THREADS
     pthread_mutex_lock(&mq->lock);
-    mq->err_recv = err;
+    avpriv_atomic_int_set(&mq->err_recv, err);
     pthread_cond_broadcast(&mq->cond_recv);
     pthread_mutex_unlock(&mq->lock);
 #endif /* HAVE_THREADS */
 }
 
-#if HAVE_THREADS
-static void free_func_wrap(void *arg, void *msg, int size)
-{
-    AVThreadMessageQueue *mq = arg;
-    mq->free_func(msg);
-}
-#endif
-
 void av_thread_message_flush(AVThreadMessageQueue *mq)
 {
 #if HAVE_THREADS
-    int used, off;
-    void *free_func = mq->free_func;
+    unsigned head, tail;
 
-    pthread_mutex_lock(&mq->lock);
-    used = av_fifo_size(mq->fifo);
-    if (free_func)
-        for (off = 0; off < used; off += mq->elsize)
-            av_fifo_generic_peek_at(mq->fifo, mq, off, mq->elsize, free_func_wrap);
-    av_fifo_drain(mq->fifo, used);
+    pthread_mutex_lock(&mq->lock_recv);
+    head = mq->head;
+    tail = avpriv_atomic_int_get(&mq->tail);
+    if (mq->free_func)
+        for (; head != tail; head++)
+            mq->free_func(mq->buf + (head & mq->mask) * mq->elsize);
+    avpriv_atomic_int_set(&mq->head, tail);
     /* only the senders need to be notified since the queue is empty and there
      * is nothing to read */
-    pthread_cond_broadcast(&mq->cond_send);
-    pthread_mutex_unlock(&mq->lock);
+    queue_wake(mq, &mq->send_waiting, &mq->cond_send);
+    pthread_mutex_unlock(&mq->lock_recv);
 #endif /* HAVE_THREADS */
 }
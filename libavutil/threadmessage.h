@@ -66,6 +66,38 @@ int av_thread_message_queue_recv(AVThreadMessageQueue *mq,
                                  void *msg,
                                  unsigned flags);
 
+/**
+ * Send several messages on the queue.
+ *
+ * The messages are stored contiguously in msgs, elsize bytes each, and are
+ * queued in order. In blocking mode, the function returns once all of them
+ * have been queued, making each part visible to the receiver as soon as it
+ * fits in the queue.
+ *
+ * @param msgs     array of nb_msgs messages
+ * @param nb_msgs  number of messages to send, must be > 0
+ * @return  the number of messages sent, or a negative error code if none
+ *          could be sent
+ */
+int av_thread_message_queue_send_batch(AVThreadMessageQueue *mq,
+                                       void *msgs, int nb_msgs,
+                                       unsigned flags);
+
+/**
+ * Receive several messages from the queue.
+ *
+ * Up to nb_msgs messages are received in a single operation. In blocking
+ * mode, the function waits until at least one message is available.
+ *
+ * @param msgs     array with room for nb_msgs messages
+ * @param nb_msgs  maximum number of messages to receive, must be > 0
+ * @return  the number of messages received, or a negative error code if none
+ *          could be received
+ */
+int av_thread_message_queue_recv_batch(AVThreadMessageQueue *mq,
+                                       void *msgs, int nb_msgs,
+                                       unsigned flags);
+
 /**
  * Set the sending error code.
  *
@@ -563,6 +563,100 @@ static av_always_inline void do_a_deblock_C(uint8_t *src, int step,
 typedef void (*pp_fn)(const uint8_t src[], int srcStride, uint8_t dst[], int dstStride, int width, int height,
                       const QP_STORE_T QPs[], int QPStride, int isColor, PPContext *c2);
 
+#if !HAVE_THREADS
+int ff_pp_thread_init(PPContext *c, int nb_threads)
+{
+    return 0;
+}
+
+void ff_pp_thread_free(PPContext *c)
+{
+}
+
+int ff_pp_thread_count(const PPContext *c)
+{
+    return 1;
+}
+
+int ff_pp_thread_execute(PPContext *c, ff_pp_thread_func *func,
+                         void *arg, int nb_rows)
+{
+    return AVERROR(ENOSYS);
+}
+
+void ff_pp_thread_await(const PPContext *c, int row, int x)
+{
+}
+
+void ff_pp_thread_report(const PPContext *c, int row, int x)
+{
+}
+#endif
+
+typedef struct PPSliceArgs {
+    pp_fn pp;
+    const uint8_t *src;
+    int srcStride;
+    uint8_t *dst;
+    int dstStride;
+    int width, height;
+    const QP_STORE_T *QPs;
+    int QPStride;
+    int isColor;
+} PPSliceArgs;
+
+static void postProcess_slice(PPContext *c, void *arg, int jobnr, int nb_jobs)
+{
+    PPSliceArgs *s = arg;
+
+    s->pp(s->src, s->srcStride, s->dst, s->dstStride, s->width, s->height,
+          s->QPs, s->QPStride, s->isColor, &c->slice_ctx[jobnr]);
+}
+
+/**
+ * Filter the block rows of one plane in parallel, every thread works on its
+ * own copy of the context. Returns a negative value if the plane has not
+ * been filtered.
+ */
+static int postProcess_threaded(pp_fn pp, const uint8_t src[], int srcStride, uint8_t dst[], int dstStride,
+                                int width, int height, const QP_STORE_T QPs[], int QPStride, int isColor,
+                                PPContext *c)
+{
+    PPSliceArgs args = { pp, src, srcStride, dst, dstStride, width, height,
+                         QPs, QPStride, isColor };
+    int nb_jobs = ff_pp_thread_count(c);
+    int i, j, ret;
+
+    for (i = 0; i < nb_jobs; i++) {
+        PPContext *sc = &c->slice_ctx[i];
+        uint8_t  *tempBlocks = sc->tempBlocks;
+        uint64_t *yHistogram = sc->yHistogram;
+
+        *sc = *c;
+        sc->tempBlocks = tempBlocks;
+        sc->yHistogram = yHistogram;
+        sc->slice_ctx  = NULL;
+        sc->jobnr      = i;
+        sc->nb_jobs    = nb_jobs;
+        memcpy(yHistogram, c->yHistogram, 256 * sizeof(*yHistogram));
+    }
+
+    ret = ff_pp_thread_execute(c, postProcess_slice, &args, (height + 7) >> 3);
+    if (ret < 0)
+        return ret;
+
+    if (!isColor) {
+        for (i = 0; i < 256; i++) {
+            uint64_t sum = c->yHistogram[i];
+            for (j = 0; j < nb_jobs; j++)
+                sum += c->slice_ctx[j].yHistogram[i] - c->yHistogram[i];
+            c->yHistogram[i] = sum;
+        }
+        c->frameNum++;
+    }
+    return 0;
+}
+
 static inline void postProcess(const uint8_t src[], int srcStride, uint8_t dst[], int dstStride, int width, int height,
         const QP_STORE_T QPs[], int QPStride, int isColor, pp_mode *vm, pp_context *vc)
 {
@@ -597,6 +691,19 @@ static inline void postProcess(const uint8_t src[], int srcStride, uint8_t dst[]
 #endif /* !CONFIG_RUNTIME_CPUDETECT */
     }
 
+    /* The luma histogram of the first two frames is special cased by the
+     * filters, keep them single threaded so that merging the per thread
+     * histograms stays trivial. The temporal noise reducer stores its
+     * thresholds far ahead of the current block and blocks overlapping the
+     * right edge write into the next line if there is no padding, these need
+     * the single threaded row order. */
+    if (c->slice_ctx && height >= 2*BLOCK_SIZE && (isColor || c->frameNum >= 1) &&
+        !((isColor ? ppMode->chromMode : ppMode->lumMode) & TEMP_NOISE_FILTER) &&
+        FFALIGN(width, BLOCK_SIZE) <= FFABS(dstStride) &&
+        postProcess_threaded(pp, src, srcStride, dst, dstStride, width, height,
+                             QPs, QPStride, isColor, c) >= 0)
+        return;
+
     pp(src, srcStride, dst, dstStride, width, height, QPs, QPStride, isColor, c);
 }
 
@@ -917,10 +1024,59 @@ av_cold pp_context *pp_get_context(int width, int height, int cpuCaps){
     return c;
 }
 
+static void free_slice_contexts(PPContext *c)
+{
+    int i;
+
+    if (c->slice_ctx) {
+        for (i = 0; i < ff_pp_thread_count(c); i++) {
+            av_free(c->slice_ctx[i].tempBlocks);
+            av_free(c->slice_ctx[i].yHistogram);
+        }
+    }
+    av_freep(&c->slice_ctx);
+    ff_pp_thread_free(c);
+}
+
+int pp_set_threads(pp_context *vc, int nb_threads)
+{
+    PPContext *c = vc;
+    int i, nb_jobs, ret;
+
+    if (nb_threads < 0)
+        return AVERROR(EINVAL);
+
+    free_slice_contexts(c);
+
+    ret = ff_pp_thread_init(c, nb_threads);
+    if (ret < 0)
+        return ret;
+
+    nb_jobs = ff_pp_thread_count(c);
+    if (nb_jobs <= 1)
+        return 0;
+
+    c->slice_ctx = av_mallocz_array(nb_jobs, sizeof(*c->slice_ctx));
+    if (!c->slice_ctx)
+        goto fail;
+    for (i = 0; i < nb_jobs; i++) {
+        c->slice_ctx[i].tempBlocks = av_mallocz(2*16*8);
+        c->slice_ctx[i].yHistogram = av_mallocz(256*sizeof(uint64_t));
+        if (!c->slice_ctx[i].tempBlocks || !c->slice_ctx[i].yHistogram)
+            goto fail;
+    }
+    return 0;
+fail:
+    free_slice_contexts(c);
+    return AVERROR(ENOMEM);
+}
+
 av_cold void pp_free_context(void *vc){
     PPContext *c = (PPContext*)vc;
     int i;
 
+    free_slice_contexts(c);
+
     for(i=0; i<FF_ARRAY_ELEMS(c->tempBlurred); i++)
         av_free(c->tempBlurred[i]);
     for(i=0; i<FF_ARRAY_ELEMS(c->tempBlurredPast); i++)
@@ -89,6 +89,17 @@ void pp_free_mode(pp_mode *mode);
 pp_context *pp_get_context(int width, int height, int flags);
 void pp_free_context(pp_context *ppContext);
 
+/**
+ * Set the number of threads pp_postprocess() uses, the picture is split
+ * into rows of 8x8 blocks which are filtered in parallel. The output does
+ * not depend on the number of threads.
+ *
+ * @param nb_threads number of threads, 0 for one thread per CPU
+ * @return 0 on success, a negative AVERROR code on failure, in which case
+ *         the context is left single threaded
+ */
+int pp_set_threads(pp_context *ppContext, int nb_threads);
+
 #define PP_CPU_CAPS_MMX   0x80000000
 #define PP_CPU_CAPS_MMX2  0x20000000
 #define PP_CPU_CAPS_3DNOW 0x40000000
@@ -109,6 +109,8 @@ typedef struct PPMode{
     int forcedQuant;                ///< quantizer if FORCE_QUANT is used
 } PPMode;
 
+typedef struct PPThreadContext PPThreadContext;
+
 /**
  * postprocess context.
  */
@@ -170,8 +172,38 @@ typedef struct PPContext{
     int vChromaSubSample;
 
     PPMode ppMode;
+
+    PPThreadContext *thread;
+    struct PPContext *slice_ctx; ///< one context per thread, NULL if single threaded
+    int jobnr;                   ///< this context filters the block rows jobnr, jobnr + nb_jobs, ...
+    int nb_jobs;
 } PPContext;
 
+typedef void (ff_pp_thread_func)(PPContext *c, void *arg, int jobnr, int nb_jobs);
+
+/**
+ * Start nb_threads threads (0 for one per CPU), on failure or if a single
+ * thread is requested c is left single threaded.
+ */
+int  ff_pp_thread_init(PPContext *c, int nb_threads);
+void ff_pp_thread_free(PPContext *c);
+int  ff_pp_thread_count(const PPContext *c);
+
+/**
+ * Run func once per thread and wait for all of them to finish.
+ *
+ * @param nb_rows number of block rows whose progress is tracked
+ */
+int  ff_pp_thread_execute(PPContext *c, ff_pp_thread_func *func,
+                          void *arg, int nb_rows);
+
+/**
+ * Wait until block row row has been filtered up to column x,
+ * INT_MAX waits for the whole row.
+ */
+void ff_pp_thread_await(const PPContext *c, int row, int x);
+void ff_pp_thread_report(const PPContext *c, int row, int x);
+
 
 static inline void linecpy(void *dest, const void *src, int lines, int stride) {
     if (stride > 0) {
@@ -1317,7 +1317,7 @@ DERING_CORE((%0, %1, 8)       ,(%%FF_REGd, %1, 4),%%mm2,%%mm4,%%mm0,%%mm3,%%mm5,
         "1:                        \n\t"
         : : "r" (src), "r" ((x86_reg)stride), "m" (c->pQPb), "m"(c->pQPb2), "q"(tmp)
           NAMED_CONSTRAINTS_ADD(deringThreshold,b00,b02,b08)
-        : "%"FF_REG_a, "%"FF_REG_d, "%"FF_REG_sp
+        : "%"FF_REG_a, "%"FF_REG_d, "%"FF_REG_sp, "memory"
     );
 #else // HAVE_7REGS && (TEMPLATE_PP_MMXEXT || TEMPLATE_PP_3DNOW)
     int y;
@@ -1441,6 +1441,30 @@ DERING_CORE((%0, %1, 8)       ,(%%FF_REGd, %1, 4),%%mm2,%%mm4,%%mm0,%%mm3,%%mm5,
 }
 #endif //TEMPLATE_PP_ALTIVEC
 
+/**
+ * Dering the first or last block of a block row. dering() reads one pixel
+ * left and right of the block, for these blocks that pixel is outside of the
+ * picture (in the previous or next line or the padding), so filter a copy
+ * which repeats the edge pixels instead.
+ */
+static inline void RENAME(deringEdge)(uint8_t src[], int stride, PPContext *c, int left, int right)
+{
+    DECLARE_ALIGNED(16, uint8_t, tmp)[10*32];
+    uint8_t *t = tmp + 16;
+    int y;
+
+    for(y=0; y<10; y++){
+        memcpy(t + 32*y, src + stride*y, 8);
+        t[32*y - 1] = left  ? t[32*y]     : src[stride*y - 1];
+        t[32*y + 8] = right ? t[32*y + 7] : src[stride*y + 8];
+    }
+
+    RENAME(dering)(t, 32, c);
+
+    for(y=1; y<9; y++)
+        memcpy(src + stride*y, t + 32*y, 8);
+}
+
 /**
  * Deinterlace the given block by linearly interpolating every second line.
  * will be called for every 8x8 block and can read & write from line 4-15
@@ -3423,7 +3447,7 @@ static void RENAME(postProcess)(const uint8_t src[], int srcStride, uint8_t dst[
 
     /* copy & deinterlace first row of blocks */
     y=-BLOCK_SIZE;
-    {
+    if(!c.jobnr){
         const uint8_t *srcBlock= &(src[y*srcStride]);
         uint8_t *dstBlock= tempDst + dstStride;
 
@@ -3480,6 +3504,15 @@ static void RENAME(postProcess)(const uint8_t src[], int srcStride, uint8_t dst[
         const int8_t *QPptr= &QPs[(y>>qpVShift)*QPStride];
         int8_t *nonBQPptr= &c.nonBQPTable[(y>>qpVShift)*FFABS(QPStride)];
         int QP=0, nonBQP=0;
+
+        if(c.nb_jobs > 1){
+            if((y>>3) % c.nb_jobs != c.jobnr)
+                continue;
+            /* the last rows go through tempDst, the row above must be complete */
+            if(y+15 >= height)
+                ff_pp_thread_await(&c, (y>>3) - 1, INT_MAX);
+        }
+
         /* can we mess with a 8x16 block from srcBlock/dstBlock downwards and 1 line upwards
            if not than use a temporary buffer */
         if(y+15 >= height){
@@ -3513,6 +3546,10 @@ static void RENAME(postProcess)(const uint8_t src[], int srcStride, uint8_t dst[
             uint8_t *dstBlockStart = dstBlock;
             const uint8_t *srcBlockStart = srcBlock;
             int qp_index = 0;
+            /* the filters below reach 9 pixels left of x, the row above
+               must be done with everything up to endx + 9 */
+            if(c.nb_jobs > 1)
+                ff_pp_thread_await(&c, (y>>3) - 1, endx + 9);
             for(qp_index=0; qp_index < (endx-startx)/BLOCK_SIZE; qp_index++){
                 QP = QPptr[(x+qp_index*BLOCK_SIZE)>>qpHShift];
                 nonBQP = nonBQPptr[(x+qp_index*BLOCK_SIZE)>>qpHShift];
@@ -3657,7 +3694,12 @@ static void RENAME(postProcess)(const uint8_t src[], int srcStride, uint8_t dst[
 #endif //TEMPLATE_PP_MMX
                 if(mode & DERING){
                 //FIXME filter first line
-                    if(y>0) RENAME(dering)(dstBlock - stride - 8, stride, &c);
+                    if(y>0){
+                        if(x == 8)
+                            RENAME(deringEdge)(dstBlock - stride - 8, stride, &c, 1, 0);
+                        else
+                            RENAME(dering)(dstBlock - stride - 8, stride, &c);
+                    }
                 }
 
                 if(mode & TEMP_NOISE_FILTER)
@@ -3678,10 +3720,12 @@ static void RENAME(postProcess)(const uint8_t src[], int srcStride, uint8_t dst[
             tempBlock2 = tmpXchg;
 #endif
           }
+          if(c.nb_jobs > 1)
+              ff_pp_thread_report(&c, y>>3, endx);
         }
 
         if(mode & DERING){
-            if(y > 0) RENAME(dering)(dstBlock - dstStride - 8, dstStride, &c);
+            if(y > 0) RENAME(deringEdge)(dstBlock - dstStride - 8, dstStride, &c, x == 8, 1);
         }
 
         if((mode & TEMP_NOISE_FILTER)){
@@ -3703,6 +3747,8 @@ static void RENAME(postProcess)(const uint8_t src[], int srcStride, uint8_t dst[
                 }
             }
         }
+        if(c.nb_jobs > 1)
+            ff_pp_thread_report(&c, y>>3, INT_MAX);
     }
 #if   TEMPLATE_PP_3DNOW
     __asm__ volatile("femms");
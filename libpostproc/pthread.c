@@ -0,0 +1,280 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Libpostproc block row threading support
+ *
+ * Every thread runs one job, job n filters the block rows n, n + nb_jobs, ...
+ * A block row may only touch pixels the row above is done with, so each job
+ * waits for the progress of the row above before filtering a group of blocks
+ * (see ff_pp_thread_await()), which keeps the output identical to the single
+ * threaded one.
+ */
+
+#include "config.h"
+
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+
+#include "postprocess_internal.h"
+
+struct PPThreadContext {
+    int nb_threads;
+    pthread_t *workers;
+    ff_pp_thread_func *func;
+
+    /* per-execute parameters */
+    PPContext *ctx;
+    void *arg;
+    int nb_jobs;
+
+    pthread_cond_t last_job_cond;
+    pthread_cond_t current_job_cond;
+    pthread_mutex_t current_job_lock;
+    int current_job;
+    unsigned int current_execute;
+    int done;
+
+    /* block row progress, row n is guarded by the lock of job n % nb_threads */
+    int *progress;
+    int nb_rows;
+    pthread_mutex_t *progress_lock;
+    pthread_cond_t *progress_cond;
+};
+
+static void* attribute_align_arg worker(void *v)
+{
+    PPThreadContext *c = v;
+    int our_job      = c->nb_jobs;
+    int nb_threads   = c->nb_threads;
+    unsigned int last_execute = 0;
+    int self_id;
+
+    pthread_mutex_lock(&c->current_job_lock);
+    self_id = c->current_job++;
+    for (;;) {
+        while (our_job >= c->nb_jobs) {
+            if (c->current_job == nb_threads + c->nb_jobs)
+                pthread_cond_signal(&c->last_job_cond);
+
+            while (last_execute == c->current_execute && !c->done)
+                pthread_cond_wait(&c->current_job_cond, &c->current_job_lock);
+            last_execute = c->current_execute;
+            our_job = self_id;
+
+            if (c->done) {
+                pthread_mutex_unlock(&c->current_job_lock);
+                return NULL;
+            }
+        }
+        pthread_mutex_unlock(&c->current_job_lock);
+
+        c->func(c->ctx, c->arg, our_job, c->nb_jobs);
+
+        pthread_mutex_lock(&c->current_job_lock);
+        our_job = c->current_job++;
+    }
+}
+
+static void slice_thread_uninit(PPThreadContext *c)
+{
+    int i;
+
+    pthread_mutex_lock(&c->current_job_lock);
+    c->done = 1;
+    pthread_cond_broadcast(&c->current_job_cond);
+    pthread_mutex_unlock(&c->current_job_lock);
+
+    for (i = 0; i < c->nb_threads; i++)
+         pthread_join(c->workers[i], NULL);
+
+    pthread_mutex_destroy(&c->current_job_lock);
+    pthread_cond_destroy(&c->current_job_cond);
+    pthread_cond_destroy(&c->last_job_cond);
+    av_freep(&c->workers);
+}
+
+static void slice_thread_park_workers(PPThreadContext *c)
+{
+    while (c->current_job != c->nb_threads + c->nb_jobs)
+        pthread_cond_wait(&c->last_job_cond, &c->current_job_lock);
+    pthread_mutex_unlock(&c->current_job_lock);
+}
+
+int ff_pp_thread_execute(PPContext *ctx, ff_pp_thread_func *func,
+                         void *arg, int nb_rows)
+{
+    PPThreadContext *c = ctx->thread;
+    int i;
+
+    if (nb_rows > c->nb_rows) {
+        int *progress = av_realloc_array(c->progress, nb_rows, sizeof(*progress));
+        if (!progress)
+            return AVERROR(ENOMEM);
+        c->progress = progress;
+        c->nb_rows  = nb_rows;
+    }
+    for (i = 0; i < nb_rows; i++)
+        c->progress[i] = -1;
+
+    pthread_mutex_lock(&c->current_job_lock);
+
+    c->current_job = c->nb_threads;
+    c->nb_jobs     = c->nb_threads;
+    c->ctx         = ctx;
+    c->arg         = arg;
+    c->func        = func;
+    c->current_execute++;
+
+    pthread_cond_broadcast(&c->current_job_cond);
+
+    slice_thread_park_workers(c);
+
+    return 0;
+}
+
+void ff_pp_thread_await(const PPContext *ctx, int row, int x)
+{
+    PPThreadContext *c = ctx->thread;
+    int job = row % c->nb_threads;
+
+    if (row < 0)
+        return;
+
+    pthread_mutex_lock(&c->progress_lock[job]);
+    while (c->progress[row] < x)
+        pthread_cond_wait(&c->progress_cond[job], &c->progress_lock[job]);
+    pthread_mutex_unlock(&c->progress_lock[job]);
+}
+
+void ff_pp_thread_report(const PPContext *ctx, int row, int x)
+{
+    PPThreadContext *c = ctx->thread;
+    int job = row % c->nb_threads;
+
+    pthread_mutex_lock(&c->progress_lock[job]);
+    c->progress[row] = x;
+    pthread_cond_signal(&c->progress_cond[job]);
+    pthread_mutex_unlock(&c->progress_lock[job]);
+}
+
+static int thread_init_internal(PPThreadContext *c, int nb_threads)
+{
+    int i, ret;
+
+    if (!nb_threads) {
+        int nb_cpus = av_cpu_count();
+        nb_threads = nb_cpus > 1 ? nb_cpus : 1;
+    }
+
+    if (nb_threads <= 1)
+        return 1;
+
+    c->nb_threads = nb_threads;
+    c->workers       = av_mallocz_array(sizeof(*c->workers),       nb_threads);
+    c->progress_lock = av_mallocz_array(sizeof(*c->progress_lock), nb_threads);
+    c->progress_cond = av_mallocz_array(sizeof(*c->progress_cond), nb_threads);
+    if (!c->workers || !c->progress_lock || !c->progress_cond) {
+        av_freep(&c->workers);
+        av_freep(&c->progress_lock);
+        av_freep(&c->progress_cond);
+        return AVERROR(ENOMEM);
+    }
+
+    for (i = 0; i < nb_threads; i++) {
+        pthread_mutex_init(&c->progress_lock[i], NULL);
+        pthread_cond_init(&c->progress_cond[i], NULL);
+    }
+
+    c->current_job = 0;
+    c->nb_jobs     = 0;
+    c->done        = 0;
+
+    pthread_cond_init(&c->current_job_cond, NULL);
+    pthread_cond_init(&c->last_job_cond,    NULL);
+
+    pthread_mutex_init(&c->current_job_lock, NULL);
+    pthread_mutex_lock(&c->current_job_lock);
+    for (i = 0; i < nb_threads; i++) {
+        ret = pthread_create(&c->workers[i], NULL, worker, c);
+        if (ret) {
+           pthread_mutex_unlock(&c->current_job_lock);
+           c->nb_threads = i;
+           slice_thread_uninit(c);
+           c->nb_threads = nb_threads;
+           return AVERROR(ret);
+        }
+    }
+
+    slice_thread_park_workers(c);
+
+    return c->nb_threads;
+}
+
+static void progress_uninit(PPThreadContext *c)
+{
+    int i;
+
+    if (c->progress_lock) {
+        for (i = 0; i < c->nb_threads; i++) {
+            pthread_mutex_destroy(&c->progress_lock[i]);
+            pthread_cond_destroy(&c->progress_cond[i]);
+        }
+    }
+    av_freep(&c->progress_lock);
+    av_freep(&c->progress_cond);
+    av_freep(&c->progress);
+}
+
+int ff_pp_thread_init(PPContext *c, int nb_threads)
+{
+    int ret;
+
+    ff_pp_thread_free(c);
+
+    c->thread = av_mallocz(sizeof(*c->thread));
+    if (!c->thread)
+        return AVERROR(ENOMEM);
+
+    ret = thread_init_internal(c->thread, nb_threads);
+    if (ret <= 1) {
+        if (ret < 0)
+            progress_uninit(c->thread);
+        av_freep(&c->thread);
+        return (ret < 0) ? ret : 0;
+    }
+
+    return 0;
+}
+
+int ff_pp_thread_count(const PPContext *c)
+{
+    return c->thread ? c->thread->nb_threads : 1;
+}
+
+void ff_pp_thread_free(PPContext *c)
+{
+    if (c->thread) {
+        slice_thread_uninit(c->thread);
+        progress_uninit(c->thread);
+    }
+    av_freep(&c->thread);
+}
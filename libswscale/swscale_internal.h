@@ -87,6 +87,14 @@ typedef int (*SwsFunc)(struct SwsContext *context, const uint8_t *src[],
                        int srcStride[], int srcSliceY, int srcSliceH,
                        uint8_t *dst[], int dstStride[]);
 
+typedef struct SwsThreadContext SwsThreadContext;
+
+/**
+ * Slice thread job, called once for each jobnr in [0, nb_jobs).
+ */
+typedef void (ff_sws_thread_func)(struct SwsContext *c, void *arg,
+                                  int jobnr, int nb_jobs);
+
 /**
  * Write one line of horizontally scaled data to planar output
  * without any additional vertical scaling (or point-scaling).
@@ -627,6 +635,14 @@ typedef struct SwsContext {
     SwsDither dither;
 
     SwsAlphaBlend alphablend;
+
+    int nb_threads;               ///< Number of slice threads, 0 for auto.
+    SwsThreadContext *thread;
+    /**
+     * Unscaled converter run on horizontal bands of the slice by the slice
+     * threads, swscale is then set to a wrapper dispatching the bands.
+     */
+    SwsFunc unscaled_slice;
 } SwsContext;
 //FIXME check init (where 0)
 
@@ -661,6 +677,11 @@ static av_always_inline int is9_OR_10BPS(enum AVPixelFormat pix_fmt)
 
 #define isNBPS(x) is9_OR_10BPS(x)
 
+static av_always_inline int isP010(enum AVPixelFormat pix_fmt)
+{
+    return pix_fmt == AV_PIX_FMT_P010LE || pix_fmt == AV_PIX_FMT_P010BE;
+}
+
 static av_always_inline int isBE(enum AVPixelFormat pix_fmt)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_fmt);
@@ -924,6 +945,14 @@ int ff_sws_alphablendaway(SwsContext *c, const uint8_t *src[],
                           int srcStride[], int srcSliceY, int srcSliceH,
                           uint8_t *dst[], int dstStride[]);
 
+/**
+ * Start c->nb_threads slice threads, on failure c is left single threaded.
+ */
+int ff_sws_thread_init(SwsContext *c);
+void ff_sws_thread_free(SwsContext *c);
+void ff_sws_thread_execute(SwsContext *c, ff_sws_thread_func *func,
+                           void *arg, int nb_jobs);
+
 static inline void fillPlane16(uint8_t *plane, int stride, int width, int height, int y,
                                int alpha, int bits, const int big_endian)
 {
@@ -197,6 +197,39 @@ static int nv12ToPlanarWrapper(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 
+static int planarToP010Wrapper(SwsContext *c, const uint8_t *src[],
+                               int srcStride[], int srcSliceY,
+                               int srcSliceH, uint8_t *dstParam[],
+                               int dstStride[])
+{
+    uint8_t *dst = dstParam[1] + dstStride[1] * srcSliceY / 2;
+
+    shiftWords(src[0], dstParam[0] + dstStride[0] * srcSliceY, c->srcW,
+               srcSliceH, srcStride[0], dstStride[0], 6);
+    interleaveWords(src[1], src[2], dst, AV_CEIL_RSHIFT(c->srcW, 1),
+                    AV_CEIL_RSHIFT(srcSliceH, 1), srcStride[1], srcStride[2],
+                    dstStride[1], 6);
+
+    return srcSliceH;
+}
+
+static int p010ToPlanarWrapper(SwsContext *c, const uint8_t *src[],
+                               int srcStride[], int srcSliceY,
+                               int srcSliceH, uint8_t *dstParam[],
+                               int dstStride[])
+{
+    uint8_t *dst1 = dstParam[1] + dstStride[1] * srcSliceY / 2;
+    uint8_t *dst2 = dstParam[2] + dstStride[2] * srcSliceY / 2;
+
+    shiftWords(src[0], dstParam[0] + dstStride[0] * srcSliceY, c->srcW,
+               srcSliceH, srcStride[0], dstStride[0], -6);
+    deinterleaveWords(src[1], dst1, dst2, AV_CEIL_RSHIFT(c->srcW, 1),
+                      AV_CEIL_RSHIFT(srcSliceH, 1), srcStride[1],
+                      dstStride[1], dstStride[2], 6);
+
+    return srcSliceH;
+}
+
 static int planarToYuy2Wrapper(SwsContext *c, const uint8_t *src[],
                                int srcStride[], int srcSliceY, int srcSliceH,
                                uint8_t *dstParam[], int dstStride[])
@@ -1467,32 +1500,15 @@ static int planarCopyWrapper(SwsContext *c, const uint8_t *src[],
                         dstPtr2 += dstStride[plane]/2;
                         srcPtr  += srcStride[plane];
                     }
+                } else if (src_depth <= dst_depth &&
+                           isBE(c->srcFormat) == HAVE_BIGENDIAN &&
+                           isBE(c->dstFormat) == HAVE_BIGENDIAN &&
+                           shiftonly) {
+                    shiftWords(srcPtr, dstPtr, length, height, srcStride[plane],
+                               dstStride[plane], dst_depth - src_depth);
                 } else if (src_depth <= dst_depth) {
                     for (i = 0; i < height; i++) {
                         j = 0;
-                        if(isBE(c->srcFormat) == HAVE_BIGENDIAN &&
-                           isBE(c->dstFormat) == HAVE_BIGENDIAN &&
-                           shiftonly) {
-                             unsigned shift = dst_depth - src_depth;
-#if HAVE_FAST_64BIT
-#define FAST_COPY_UP(shift) \
-    for (; j < length - 3; j += 4) { \
-        uint64_t v = AV_RN64A(srcPtr2 + j); \
-        AV_WN64A(dstPtr2 + j, v << shift); \
-    }
-#else
-#define FAST_COPY_UP(shift) \
-    for (; j < length - 1; j += 2) { \
-        uint32_t v = AV_RN32A(srcPtr2 + j); \
-        AV_WN32A(dstPtr2 + j, v << shift); \
-    }
-#endif
-                             switch (shift)
-                             {
-                             case 6: FAST_COPY_UP(6); break;
-                             case 7: FAST_COPY_UP(7); break;
-                             }
-                        }
 #define COPY_UP(r,w) \
     if(shiftonly){\
         for (; j < length; j++){ \
@@ -1567,6 +1583,58 @@ static int planarCopyWrapper(SwsContext *c, const uint8_t *src[],
 }
 
 
+#if HAVE_THREADS
+/* Bands are a multiple of the 8 line dither period on subsampled chroma. */
+#define UNSCALED_BAND_ALIGN 16
+
+typedef struct UnscaledBandArgs {
+    const uint8_t **src;
+    int *srcStride;
+    int srcSliceY;
+    int srcSliceH;
+    uint8_t **dst;
+    int *dstStride;
+    int nb_planes;
+    int band_h;
+} UnscaledBandArgs;
+
+static void unscaled_band(SwsContext *c, void *arg, int jobnr, int nb_jobs)
+{
+    UnscaledBandArgs *a = arg;
+    int y = jobnr * a->band_h;
+    const uint8_t *src[4];
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        int vsub = (i == 1 || i == 2) ? c->chrSrcVSubSample : 0;
+        src[i] = a->src[i];
+        if (i < a->nb_planes && src[i])
+            src[i] += (y >> vsub) * a->srcStride[i];
+    }
+    c->unscaled_slice(c, src, a->srcStride, a->srcSliceY + y,
+                      FFMIN(a->band_h, a->srcSliceH - y), a->dst, a->dstStride);
+}
+
+static int unscaledThreadWrapper(SwsContext *c, const uint8_t *src[],
+                                 int srcStride[], int srcSliceY, int srcSliceH,
+                                 uint8_t *dst[], int dstStride[])
+{
+    UnscaledBandArgs args = { src, srcStride, srcSliceY, srcSliceH, dst, dstStride };
+    int nb_jobs = FFMIN(c->nb_threads, srcSliceH / UNSCALED_BAND_ALIGN);
+
+    if (nb_jobs <= 1)
+        return c->unscaled_slice(c, src, srcStride, srcSliceY, srcSliceH,
+                                 dst, dstStride);
+
+    args.nb_planes = av_pix_fmt_count_planes(c->srcFormat);
+    args.band_h    = FFALIGN((srcSliceH + nb_jobs - 1) / nb_jobs, UNSCALED_BAND_ALIGN);
+    nb_jobs        = (srcSliceH + args.band_h - 1) / args.band_h;
+    ff_sws_thread_execute(c, unscaled_band, &args, nb_jobs);
+
+    return srcSliceH;
+}
+#endif
+
 #define IS_DIFFERENT_ENDIANESS(src_fmt, dst_fmt, pix_fmt)          \
     ((src_fmt == pix_fmt ## BE && dst_fmt == pix_fmt ## LE) ||     \
      (src_fmt == pix_fmt ## LE && dst_fmt == pix_fmt ## BE))
@@ -1594,6 +1662,15 @@ void ff_get_unscaled_swscale(SwsContext *c)
         (srcFormat == AV_PIX_FMT_NV12 || srcFormat == AV_PIX_FMT_NV21)) {
         c->swscale = nv12ToPlanarWrapper;
     }
+    /* yuv420p10_to_p010 */
+    if ((srcFormat == AV_PIX_FMT_YUV420P10 || srcFormat == AV_PIX_FMT_YUVA420P10) &&
+        dstFormat == AV_PIX_FMT_P010) {
+        c->swscale = planarToP010Wrapper;
+    }
+    /* p010_to_yuv420p10 */
+    if (srcFormat == AV_PIX_FMT_P010 && dstFormat == AV_PIX_FMT_YUV420P10) {
+        c->swscale = p010ToPlanarWrapper;
+    }
     /* yuv2bgr */
     if ((srcFormat == AV_PIX_FMT_YUV420P || srcFormat == AV_PIX_FMT_YUV422P ||
          srcFormat == AV_PIX_FMT_YUVA420P) && isAnyRGB(dstFormat) &&
@@ -1781,6 +1858,22 @@ void ff_get_unscaled_swscale(SwsContext *c)
          ff_get_unscaled_swscale_arm(c);
     if (ARCH_AARCH64)
         ff_get_unscaled_swscale_aarch64(c);
+
+#if HAVE_THREADS
+    /* converters which process each line independently of the others */
+    if (c->nb_threads != 1 &&
+        (c->swscale == planarCopyWrapper   || c->swscale == packedCopyWrapper   ||
+         c->swscale == planarToNv12Wrapper || c->swscale == nv12ToPlanarWrapper ||
+         c->swscale == planarToP010Wrapper || c->swscale == p010ToPlanarWrapper)) {
+        if (!c->thread && ff_sws_thread_init(c) < 0)
+            av_log(c, AV_LOG_WARNING,
+                   "Failed to start slice threads, converting in a single thread\n");
+        if (c->thread) {
+            c->unscaled_slice = c->swscale;
+            c->swscale        = unscaledThreadWrapper;
+        }
+    }
+#endif
 }
 
 /* Convert the palette to the same packed 32-bit format as the palette */
@@ -142,6 +142,150 @@ DECLARE_ALIGNED(8, extern const uint64_t, ff_bgr2UVOffset);
  32-bit C version, and and&add trick by Michael Niedermayer
 */
 
+#if HAVE_SSE2_INLINE
+static void interleaveWords_sse2(const uint8_t *src1, const uint8_t *src2,
+                                 uint8_t *dest, int width, int height,
+                                 int src1Stride, int src2Stride, int dstStride,
+                                 int shift)
+{
+    int h;
+
+    for (h = 0; h < height; h++) {
+        const uint16_t *s1 = (const uint16_t *)src1;
+        const uint16_t *s2 = (const uint16_t *)src2;
+        uint16_t *d        = (uint16_t *)dest;
+        x86_reg w = 0;
+
+        if (width >= 8) {
+            __asm__ volatile(
+                "movd                 %5, %%xmm7            \n\t"
+                "1:                                         \n\t"
+                "movdqu      (%1, %0, 2), %%xmm0            \n\t"
+                "movdqu      (%2, %0, 2), %%xmm1            \n\t"
+                "psllw            %%xmm7, %%xmm0            \n\t"
+                "psllw            %%xmm7, %%xmm1            \n\t"
+                "movdqa           %%xmm0, %%xmm2            \n\t"
+                "punpcklwd        %%xmm1, %%xmm0            \n\t"
+                "punpckhwd        %%xmm1, %%xmm2            \n\t"
+                "movdqu           %%xmm0,   (%3, %0, 4)     \n\t"
+                "movdqu           %%xmm2, 16(%3, %0, 4)     \n\t"
+                "add                  $8, %0                \n\t"
+                "cmp                  %4, %0                \n\t"
+                " jb                  1b                    \n\t"
+                : "+r"(w)
+                : "r"(s1), "r"(s2), "r"(d), "r"((x86_reg)width - 7), "r"(shift)
+                : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm7",) "memory"
+            );
+        }
+        for (; w < width; w++) {
+            d[2 * w + 0] = s1[w] << shift;
+            d[2 * w + 1] = s2[w] << shift;
+        }
+        dest += dstStride;
+        src1 += src1Stride;
+        src2 += src2Stride;
+    }
+}
+
+static void deinterleaveWords_sse2(const uint8_t *src, uint8_t *dst1, uint8_t *dst2,
+                                   int width, int height, int srcStride,
+                                   int dst1Stride, int dst2Stride, int shift)
+{
+    int h;
+
+    for (h = 0; h < height; h++) {
+        const uint16_t *s = (const uint16_t *)src;
+        uint16_t *d1      = (uint16_t *)dst1;
+        uint16_t *d2      = (uint16_t *)dst2;
+        x86_reg w = 0;
+
+        /* Split even and odd words by sign extending them to dwords, which
+         * packssdw turns back into the same 16-bit patterns. */
+        if (width >= 8) {
+            __asm__ volatile(
+                "movd                 %5, %%xmm7            \n\t"
+                "1:                                         \n\t"
+                "movdqu      (%1, %0, 4), %%xmm0            \n\t"
+                "movdqu    16(%1, %0, 4), %%xmm1            \n\t"
+                "psrlw            %%xmm7, %%xmm0            \n\t"
+                "psrlw            %%xmm7, %%xmm1            \n\t"
+                "movdqa           %%xmm0, %%xmm2            \n\t"
+                "movdqa           %%xmm1, %%xmm3            \n\t"
+                "pslld               $16, %%xmm0            \n\t"
+                "pslld               $16, %%xmm1            \n\t"
+                "psrad               $16, %%xmm0            \n\t"
+                "psrad               $16, %%xmm1            \n\t"
+                "psrad               $16, %%xmm2            \n\t"
+                "psrad               $16, %%xmm3            \n\t"
+                "packssdw         %%xmm1, %%xmm0            \n\t"
+                "packssdw         %%xmm3, %%xmm2            \n\t"
+                "movdqu           %%xmm0, (%2, %0, 2)       \n\t"
+                "movdqu           %%xmm2, (%3, %0, 2)       \n\t"
+                "add                  $8, %0                \n\t"
+                "cmp                  %4, %0                \n\t"
+                " jb                  1b                    \n\t"
+                : "+r"(w)
+                : "r"(s), "r"(d1), "r"(d2), "r"((x86_reg)width - 7), "r"(shift)
+                : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm7",) "memory"
+            );
+        }
+        for (; w < width; w++) {
+            d1[w] = s[2 * w + 0] >> shift;
+            d2[w] = s[2 * w + 1] >> shift;
+        }
+        src  += srcStride;
+        dst1 += dst1Stride;
+        dst2 += dst2Stride;
+    }
+}
+
+#define SHIFT_WORDS(op)                                             \
+    __asm__ volatile(                                               \
+        "movd                 %4, %%xmm7            \n\t"           \
+        "1:                                         \n\t"           \
+        "movdqu      (%1, %0, 2), %%xmm0            \n\t"           \
+        "movdqu    16(%1, %0, 2), %%xmm1            \n\t"           \
+        op"               %%xmm7, %%xmm0            \n\t"           \
+        op"               %%xmm7, %%xmm1            \n\t"           \
+        "movdqu           %%xmm0,   (%2, %0, 2)     \n\t"           \
+        "movdqu           %%xmm1, 16(%2, %0, 2)     \n\t"           \
+        "add                 $16, %0                \n\t"           \
+        "cmp                  %3, %0                \n\t"           \
+        " jb                  1b                    \n\t"           \
+        : "+r"(w)                                                   \
+        : "r"(s), "r"(d), "r"((x86_reg)width - 15), "r"(FFABS(shift)) \
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm7",) "memory"            \
+    )
+
+static void shiftWords_sse2(const uint8_t *src, uint8_t *dst, int width, int height,
+                            int srcStride, int dstStride, int shift)
+{
+    int h;
+
+    for (h = 0; h < height; h++) {
+        const uint16_t *s = (const uint16_t *)src;
+        uint16_t *d       = (uint16_t *)dst;
+        x86_reg w = 0;
+
+        if (width >= 16) {
+            if (shift >= 0)
+                SHIFT_WORDS("psllw");
+            else
+                SHIFT_WORDS("psrlw");
+        }
+        if (shift >= 0) {
+            for (; w < width; w++)
+                d[w] = s[w] << shift;
+        } else {
+            for (; w < width; w++)
+                d[w] = s[w] >> -shift;
+        }
+        src += srcStride;
+        dst += dstStride;
+    }
+}
+#endif /* HAVE_SSE2_INLINE */
+
 #endif /* HAVE_INLINE_ASM */
 
 av_cold void rgb2rgb_init_x86(void)
@@ -159,5 +303,12 @@ av_cold void rgb2rgb_init_x86(void)
         rgb2rgb_init_sse2();
     if (INLINE_AVX(cpu_flags))
         rgb2rgb_init_avx();
+#if HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags)) {
+        interleaveWords   = interleaveWords_sse2;
+        deinterleaveWords = deinterleaveWords_sse2;
+        shiftWords        = shiftWords_sse2;
+    }
+#endif
 #endif /* HAVE_INLINE_ASM */
 }
@@ -0,0 +1,246 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * shm devices test.
+ * Writes frames with the shm output device, reads them back with the shm
+ * input device in the same process and prints their checksums. Also checks
+ * that the wrapped_avframe decoder refuses packets not marked as trusted.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "libavcodec/avcodec.h"
+#include "libavdevice/avdevice.h"
+#include "libavformat/avformat.h"
+#include "libavutil/adler32.h"
+#include "libavutil/pixdesc.h"
+
+#define WIDTH            64
+#define HEIGHT           48
+#define NUMBER_OF_FRAMES 10
+
+static int fill_frame(AVFrame *frame, int n)
+{
+    AVFrameSideData *sd;
+    char value[16];
+    int p, x, y, ret;
+
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width  = WIDTH;
+    frame->height = HEIGHT;
+    ret = av_frame_get_buffer(frame, 32);
+    if (ret < 0)
+        return ret;
+
+    for (p = 0; p < 3; p++) {
+        int w = p ? WIDTH  / 2 : WIDTH;
+        int h = p ? HEIGHT / 2 : HEIGHT;
+        for (y = 0; y < h; y++)
+            for (x = 0; x < w; x++)
+                frame->data[p][y * frame->linesize[p] + x] = x + 3 * y + 7 * n + 50 * p;
+    }
+
+    frame->pts       = n;
+    frame->key_frame = !n;
+    frame->pict_type = n ? AV_PICTURE_TYPE_P : AV_PICTURE_TYPE_I;
+
+    sd = av_frame_new_side_data(frame, AV_FRAME_DATA_A53_CC, 3 + n);
+    if (!sd)
+        return AVERROR(ENOMEM);
+    for (x = 0; x < sd->size; x++)
+        sd->data[x] = n + x;
+
+    snprintf(value, sizeof(value), "%d", n);
+    return av_dict_set(&frame->metadata, "frame", value, 0);
+}
+
+static void print_frame(const AVFrame *frame)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    AVDictionaryEntry *e = NULL;
+    uint32_t crc = 0;
+    int i, p, y;
+
+    for (p = 0; p < 3; p++) {
+        int w = p ? AV_CEIL_RSHIFT(frame->width,  desc->log2_chroma_w) : frame->width;
+        int h = p ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h) : frame->height;
+        for (y = 0; y < h; y++)
+            crc = av_adler32_update(crc, frame->data[p] + y * frame->linesize[p], w);
+    }
+    printf("%"PRId64", %dx%d %s, key %d, type %c, 0x%08"PRIx32,
+           frame->pts, frame->width, frame->height, desc->name,
+           frame->key_frame, av_get_picture_type_char(frame->pict_type), crc);
+
+    for (i = 0; i < frame->nb_side_data; i++)
+        printf(", side data %d size %d 0x%08"PRIx32, frame->side_data[i]->type,
+               frame->side_data[i]->size,
+               (uint32_t)av_adler32_update(0, frame->side_data[i]->data, frame->side_data[i]->size));
+    while ((e = av_dict_get(frame->metadata, "", e, AV_DICT_IGNORE_SUFFIX)))
+        printf(", %s=%s", e->key, e->value);
+    printf("\n");
+}
+
+static int open_codec(AVCodecContext **avctx, AVCodec *codec)
+{
+    AVCodecContext *ctx = avcodec_alloc_context3(codec);
+
+    if (!ctx)
+        return AVERROR(ENOMEM);
+    ctx->width     = WIDTH;
+    ctx->height    = HEIGHT;
+    ctx->pix_fmt   = AV_PIX_FMT_YUV420P;
+    ctx->time_base = (AVRational){ 1, 25 };
+    *avctx = ctx;
+    return avcodec_open2(ctx, codec, NULL);
+}
+
+static int run_test(const char *name)
+{
+    AVFormatContext *oc = NULL, *ic = NULL;
+    AVCodecContext *enc = NULL, *dec = NULL;
+    AVFrame *frame = NULL;
+    AVPacket pkt, untrusted;
+    AVStream *st;
+    int i, ret;
+
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+
+    frame = av_frame_alloc();
+    if (!frame)
+        return AVERROR(ENOMEM);
+
+    ret = open_codec(&enc, avcodec_find_encoder(AV_CODEC_ID_WRAPPED_AVFRAME));
+    if (ret < 0)
+        goto end;
+    ret = open_codec(&dec, avcodec_find_decoder(AV_CODEC_ID_WRAPPED_AVFRAME));
+    if (ret < 0)
+        goto end;
+
+    ret = avformat_alloc_output_context2(&oc, NULL, "shm", name);
+    if (ret < 0)
+        goto end;
+    st = avformat_new_stream(oc, NULL);
+    if (!st) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    st->time_base = enc->time_base;
+    ret = avcodec_parameters_from_context(st->codecpar, enc);
+    if (ret < 0)
+        goto end;
+    ret = avformat_write_header(oc, NULL);
+    if (ret < 0)
+        goto end;
+
+    /* the ring exists now, so opening the input does not block */
+    ret = avformat_open_input(&ic, name, av_find_input_format("shm"), NULL);
+    if (ret < 0)
+        goto end;
+
+    for (i = 0; i < NUMBER_OF_FRAMES; i++) {
+        ret = fill_frame(frame, i);
+        if (ret < 0)
+            goto end;
+        ret = avcodec_send_frame(enc, frame);
+        av_frame_unref(frame);
+        if (ret < 0)
+            goto end;
+        ret = avcodec_receive_packet(enc, &pkt);
+        if (ret < 0)
+            goto end;
+        av_packet_rescale_ts(&pkt, enc->time_base, oc->streams[0]->time_base);
+        ret = av_write_frame(oc, &pkt);
+        av_packet_unref(&pkt);
+        if (ret < 0)
+            goto end;
+
+        ret = av_read_frame(ic, &pkt);
+        if (ret < 0)
+            goto end;
+
+        if (!i) {
+            ret = av_packet_ref(&untrusted, &pkt);
+            if (ret < 0)
+                goto end;
+            untrusted.flags &= ~AV_PKT_FLAG_TRUSTED;
+            ret = avcodec_send_packet(dec, &untrusted);
+            av_packet_unref(&untrusted);
+            if (ret != AVERROR(EPERM)) {
+                av_log(NULL, AV_LOG_ERROR, "Untrusted packet not rejected\n");
+                ret = AVERROR_BUG;
+                goto end;
+            }
+            printf("untrusted packet rejected\n");
+        }
+
+        ret = avcodec_send_packet(dec, &pkt);
+        av_packet_unref(&pkt);
+        if (ret < 0)
+            goto end;
+        ret = avcodec_receive_frame(dec, frame);
+        if (ret < 0)
+            goto end;
+        print_frame(frame);
+        /* frees the slot for the writer */
+        av_frame_unref(frame);
+    }
+
+    ret = av_write_trailer(oc);
+    if (ret < 0)
+        goto end;
+    ret = av_read_frame(ic, &pkt);
+    if (ret != AVERROR_EOF) {
+        av_log(NULL, AV_LOG_ERROR, "Missing end of stream\n");
+        av_packet_unref(&pkt);
+        ret = AVERROR_BUG;
+        goto end;
+    }
+    printf("end of stream\n");
+    ret = 0;
+
+end:
+    avformat_close_input(&ic);
+    avformat_free_context(oc);
+    avcodec_free_context(&enc);
+    avcodec_free_context(&dec);
+    av_frame_free(&frame);
+    return ret;
+}
+
+int main(void)
+{
+    char name[64];
+    int ret;
+
+    av_register_all();
+    avdevice_register_all();
+
+    snprintf(name, sizeof(name), "/fate-api-shm-%d", (int)getpid());
+    ret = run_test(name);
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Test failed: %s\n", av_err2str(ret));
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,541 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/avcodec.h"
+#include "libavcodec/hevcdsp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+static const int bit_depths[] = { 8, 10, 12 };
+static const int pel_sizes[10] = { 2, 4, 6, 8, 12, 16, 24, 32, 48, 64 };
+static const int sao_sizes[5]  = { 8, 16, 32, 48, 64 };
+
+#define SIZEOF_PIXEL ((bit_depth + 7) / 8)
+#define PIXEL_MASK   ((1 << bit_depth) - 1)
+
+static void randomize_pixels(uint8_t *buf, int n, int bit_depth)
+{
+    int k;
+
+    if (bit_depth == 8) {
+        for (k = 0; k < n; k++)
+            buf[k] = rnd();
+    } else {
+        for (k = 0; k < n; k++)
+            AV_WN16A(buf + 2 * k, rnd() & PIXEL_MASK);
+    }
+}
+
+/* mc source: 3 pixels of filter context before and 4 after in both
+ * directions, with room for 16-bit pixels */
+#define MC_SRC_STRIDE  ((MAX_PB_SIZE + 16) * 2)
+#define MC_SRC_SIZE    (MC_SRC_STRIDE * (MAX_PB_SIZE + 8))
+#define MC_SRC_OFFSET  (4 * MC_SRC_STRIDE + 16)
+#define MC_DST_STRIDE  (MAX_PB_SIZE * 2)
+#define MC_DST_SIZE    (MC_DST_STRIDE * MAX_PB_SIZE)
+
+static const char *const mc_types[2][2] = {
+    { "pixels", "h"  },
+    { "v",      "hv" },
+};
+
+#define mc_mx(epel) ((epel) ? 1 + rnd() % 7 : 1 + rnd() % 3)
+
+#define randomize_mc_buffers()                                           \
+    do {                                                                 \
+        int k;                                                           \
+        randomize_pixels(src0, MC_SRC_SIZE / SIZEOF_PIXEL, bit_depth);   \
+        memcpy(src1, src0, MC_SRC_SIZE);                                 \
+        for (k = 0; k < MC_DST_SIZE; k += 4) {                           \
+            uint32_t r = rnd();                                          \
+            AV_WN32A(dst0 + k, r);                                       \
+            AV_WN32A(dst1 + k, r);                                       \
+        }                                                                \
+        for (k = 0; k < MAX_PB_SIZE * MAX_PB_SIZE; k++)                  \
+            src2[k] = rnd() & 0x3fff;                                    \
+    } while (0)
+
+#define check_mc_rows(d0, d1, dstride, rowbytes)                         \
+    do {                                                                 \
+        int y;                                                           \
+        for (y = 0; y < size; y++)                                       \
+            if (memcmp((d0) + y * (dstride), (d1) + y * (dstride),       \
+                       rowbytes)) {                                      \
+                fail();                                                  \
+                break;                                                   \
+            }                                                            \
+    } while (0)
+
+static void check_mc(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, src2, [MAX_PB_SIZE * MAX_PB_SIZE]);
+    HEVCDSPContext h;
+    int d, epel, i, mx, my;
+    declare_func(void, int16_t *dst, uint8_t *src, ptrdiff_t srcstride,
+                 int height, intptr_t mx, intptr_t my, int width);
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (epel = 0; epel < 2; epel++)
+            for (my = 0; my < 2; my++)
+                for (mx = 0; mx < 2; mx++)
+                    for (i = 0; i < 10; i++) {
+                        int size = pel_sizes[i];
+                        void *f  = epel ? h.put_hevc_epel[i][my][mx] : h.put_hevc_qpel[i][my][mx];
+                        if (check_func(f, "put_hevc_%s_%s%d_%d", epel ? "epel" : "qpel",
+                                       mc_types[my][mx], size, bit_depth)) {
+                            intptr_t fx = mx ? mc_mx(epel) : 0;
+                            intptr_t fy = my ? mc_mx(epel) : 0;
+                            randomize_mc_buffers();
+                            call_ref((int16_t *)dst0, src0 + MC_SRC_OFFSET, MC_SRC_STRIDE, size, fx, fy, size);
+                            call_new((int16_t *)dst1, src1 + MC_SRC_OFFSET, MC_SRC_STRIDE, size, fx, fy, size);
+                            check_mc_rows(dst0, dst1, MAX_PB_SIZE * 2, size * 2);
+                            bench_new((int16_t *)dst1, src1 + MC_SRC_OFFSET, MC_SRC_STRIDE, size, fx, fy, size);
+                        }
+                    }
+    }
+    report("mc");
+}
+
+static void check_mc_uni(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, src2, [MAX_PB_SIZE * MAX_PB_SIZE]);
+    HEVCDSPContext h;
+    int d, epel, i, mx, my;
+    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src, ptrdiff_t srcstride,
+                 int height, intptr_t mx, intptr_t my, int width);
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (epel = 0; epel < 2; epel++)
+            for (my = 0; my < 2; my++)
+                for (mx = 0; mx < 2; mx++)
+                    for (i = 0; i < 10; i++) {
+                        int size = pel_sizes[i];
+                        void *f  = epel ? h.put_hevc_epel_uni[i][my][mx] : h.put_hevc_qpel_uni[i][my][mx];
+                        if (check_func(f, "put_hevc_%s_uni_%s%d_%d", epel ? "epel" : "qpel",
+                                       mc_types[my][mx], size, bit_depth)) {
+                            intptr_t fx = mx ? mc_mx(epel) : 0;
+                            intptr_t fy = my ? mc_mx(epel) : 0;
+                            randomize_mc_buffers();
+                            call_ref(dst0, MC_DST_STRIDE, src0 + MC_SRC_OFFSET, MC_SRC_STRIDE, size, fx, fy, size);
+                            call_new(dst1, MC_DST_STRIDE, src1 + MC_SRC_OFFSET, MC_SRC_STRIDE, size, fx, fy, size);
+                            check_mc_rows(dst0, dst1, MC_DST_STRIDE, size * SIZEOF_PIXEL);
+                            bench_new(dst1, MC_DST_STRIDE, src1 + MC_SRC_OFFSET, MC_SRC_STRIDE, size, fx, fy, size);
+                        }
+                    }
+    }
+    report("mc_uni");
+}
+
+static void check_mc_uni_w(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, src2, [MAX_PB_SIZE * MAX_PB_SIZE]);
+    HEVCDSPContext h;
+    int d, epel, i, mx, my;
+    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src, ptrdiff_t srcstride,
+                 int height, int denom, int wx, int ox, intptr_t mx, intptr_t my, int width);
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (epel = 0; epel < 2; epel++)
+            for (my = 0; my < 2; my++)
+                for (mx = 0; mx < 2; mx++)
+                    for (i = 0; i < 10; i++) {
+                        int size = pel_sizes[i];
+                        void *f  = epel ? h.put_hevc_epel_uni_w[i][my][mx] : h.put_hevc_qpel_uni_w[i][my][mx];
+                        if (check_func(f, "put_hevc_%s_uni_w_%s%d_%d", epel ? "epel" : "qpel",
+                                       mc_types[my][mx], size, bit_depth)) {
+                            intptr_t fx = mx ? mc_mx(epel) : 0;
+                            intptr_t fy = my ? mc_mx(epel) : 0;
+                            int denom   = rnd() % 8;
+                            int wx      = (1 << denom) + (int8_t)rnd();
+                            int ox      = (int8_t)rnd();
+                            randomize_mc_buffers();
+                            call_ref(dst0, MC_DST_STRIDE, src0 + MC_SRC_OFFSET, MC_SRC_STRIDE,
+                                     size, denom, wx, ox, fx, fy, size);
+                            call_new(dst1, MC_DST_STRIDE, src1 + MC_SRC_OFFSET, MC_SRC_STRIDE,
+                                     size, denom, wx, ox, fx, fy, size);
+                            check_mc_rows(dst0, dst1, MC_DST_STRIDE, size * SIZEOF_PIXEL);
+                            bench_new(dst1, MC_DST_STRIDE, src1 + MC_SRC_OFFSET, MC_SRC_STRIDE,
+                                      size, denom, wx, ox, fx, fy, size);
+                        }
+                    }
+    }
+    report("mc_uni_w");
+}
+
+static void check_mc_bi(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, src2, [MAX_PB_SIZE * MAX_PB_SIZE]);
+    HEVCDSPContext h;
+    int d, epel, i, mx, my;
+    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src, ptrdiff_t srcstride,
+                 int16_t *src2, int height, intptr_t mx, intptr_t my, int width);
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (epel = 0; epel < 2; epel++)
+            for (my = 0; my < 2; my++)
+                for (mx = 0; mx < 2; mx++)
+                    for (i = 0; i < 10; i++) {
+                        int size = pel_sizes[i];
+                        void *f  = epel ? h.put_hevc_epel_bi[i][my][mx] : h.put_hevc_qpel_bi[i][my][mx];
+                        if (check_func(f, "put_hevc_%s_bi_%s%d_%d", epel ? "epel" : "qpel",
+                                       mc_types[my][mx], size, bit_depth)) {
+                            intptr_t fx = mx ? mc_mx(epel) : 0;
+                            intptr_t fy = my ? mc_mx(epel) : 0;
+                            randomize_mc_buffers();
+                            call_ref(dst0, MC_DST_STRIDE, src0 + MC_SRC_OFFSET, MC_SRC_STRIDE,
+                                     src2, size, fx, fy, size);
+                            call_new(dst1, MC_DST_STRIDE, src1 + MC_SRC_OFFSET, MC_SRC_STRIDE,
+                                     src2, size, fx, fy, size);
+                            check_mc_rows(dst0, dst1, MC_DST_STRIDE, size * SIZEOF_PIXEL);
+                            bench_new(dst1, MC_DST_STRIDE, src1 + MC_SRC_OFFSET, MC_SRC_STRIDE,
+                                      src2, size, fx, fy, size);
+                        }
+                    }
+    }
+    report("mc_bi");
+}
+
+static void check_mc_bi_w(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, src2, [MAX_PB_SIZE * MAX_PB_SIZE]);
+    HEVCDSPContext h;
+    int d, epel, i, mx, my;
+    declare_func(void, uint8_t *dst, ptrdiff_t dststride, uint8_t *src, ptrdiff_t srcstride,
+                 int16_t *src2, int height, int denom, int wx0, int wx1,
+                 int ox0, int ox1, intptr_t mx, intptr_t my, int width);
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (epel = 0; epel < 2; epel++)
+            for (my = 0; my < 2; my++)
+                for (mx = 0; mx < 2; mx++)
+                    for (i = 0; i < 10; i++) {
+                        int size = pel_sizes[i];
+                        void *f  = epel ? h.put_hevc_epel_bi_w[i][my][mx] : h.put_hevc_qpel_bi_w[i][my][mx];
+                        if (check_func(f, "put_hevc_%s_bi_w_%s%d_%d", epel ? "epel" : "qpel",
+                                       mc_types[my][mx], size, bit_depth)) {
+                            intptr_t fx = mx ? mc_mx(epel) : 0;
+                            intptr_t fy = my ? mc_mx(epel) : 0;
+                            int denom   = rnd() % 8;
+                            int wx0     = (1 << denom) + (int8_t)rnd();
+                            int wx1     = (1 << denom) + (int8_t)rnd();
+                            int ox0     = (int8_t)rnd();
+                            int ox1     = (int8_t)rnd();
+                            randomize_mc_buffers();
+                            call_ref(dst0, MC_DST_STRIDE, src0 + MC_SRC_OFFSET, MC_SRC_STRIDE,
+                                     src2, size, denom, wx0, wx1, ox0, ox1, fx, fy, size);
+                            call_new(dst1, MC_DST_STRIDE, src1 + MC_SRC_OFFSET, MC_SRC_STRIDE,
+                                     src2, size, denom, wx0, wx1, ox0, ox1, fx, fy, size);
+                            check_mc_rows(dst0, dst1, MC_DST_STRIDE, size * SIZEOF_PIXEL);
+                            bench_new(dst1, MC_DST_STRIDE, src1 + MC_SRC_OFFSET, MC_SRC_STRIDE,
+                                      src2, size, denom, wx0, wx1, ox0, ox1, fx, fy, size);
+                        }
+                    }
+    }
+    report("mc_bi_w");
+}
+
+/* sao_edge_filter reads its source with this fixed stride, see hevcdsp.h */
+#define SAO_SRC_STRIDE (2 * MAX_PB_SIZE + AV_INPUT_BUFFER_PADDING_SIZE)
+#define SAO_SRC_SIZE   (SAO_SRC_STRIDE * (MAX_PB_SIZE + 2))
+#define SAO_SRC_OFFSET (SAO_SRC_STRIDE + 32)
+#define SAO_DST_STRIDE (MAX_PB_SIZE * 2)
+#define SAO_DST_SIZE   (SAO_DST_STRIDE * MAX_PB_SIZE)
+
+static void randomize_sao_offsets(int16_t *offset_val, int bit_depth)
+{
+    int range = (1 << (FFMIN(bit_depth, 10) - 5)) - 1;
+    int k;
+
+    offset_val[0] = 0;
+    for (k = 1; k < 5; k++)
+        offset_val[k] = (int)(rnd() % (2 * range + 1)) - range;
+}
+
+static void check_sao(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [SAO_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [SAO_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [SAO_DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [SAO_DST_SIZE]);
+    int16_t offset_val[5];
+    HEVCDSPContext h;
+    int d, i;
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (i = 0; i < 5; i++) {
+            int size = sao_sizes[i];
+            declare_func(void, uint8_t *dst, uint8_t *src, ptrdiff_t stride_dst, ptrdiff_t stride_src,
+                         int16_t *sao_offset_val, int sao_left_class, int width, int height);
+
+            if (check_func(h.sao_band_filter[i], "hevc_sao_band_%d_%d", size, bit_depth)) {
+                int left_class = rnd() & 31;
+                randomize_pixels(src0, SAO_SRC_SIZE / SIZEOF_PIXEL, bit_depth);
+                memcpy(src1, src0, SAO_SRC_SIZE);
+                memset(dst0, 0, SAO_DST_SIZE);
+                memset(dst1, 0, SAO_DST_SIZE);
+                randomize_sao_offsets(offset_val, bit_depth);
+                call_ref(dst0, src0 + SAO_SRC_OFFSET, SAO_DST_STRIDE, SAO_SRC_STRIDE,
+                         offset_val, left_class, size, size);
+                call_new(dst1, src1 + SAO_SRC_OFFSET, SAO_DST_STRIDE, SAO_SRC_STRIDE,
+                         offset_val, left_class, size, size);
+                check_mc_rows(dst0, dst1, SAO_DST_STRIDE, size * SIZEOF_PIXEL);
+                bench_new(dst1, src1 + SAO_SRC_OFFSET, SAO_DST_STRIDE, SAO_SRC_STRIDE,
+                          offset_val, left_class, size, size);
+            }
+        }
+    }
+    report("sao_band");
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (i = 0; i < 5; i++) {
+            int size = sao_sizes[i];
+            declare_func(void, uint8_t *dst, uint8_t *src, ptrdiff_t stride_dst,
+                         int16_t *sao_offset_val, int sao_eo_class, int width, int height);
+
+            if (check_func(h.sao_edge_filter[i], "hevc_sao_edge_%d_%d", size, bit_depth)) {
+                int eo = rnd() & 3;
+                randomize_pixels(src0, SAO_SRC_SIZE / SIZEOF_PIXEL, bit_depth);
+                memcpy(src1, src0, SAO_SRC_SIZE);
+                memset(dst0, 0, SAO_DST_SIZE);
+                memset(dst1, 0, SAO_DST_SIZE);
+                randomize_sao_offsets(offset_val, bit_depth);
+                call_ref(dst0, src0 + SAO_SRC_OFFSET, SAO_DST_STRIDE, offset_val, eo, size, size);
+                call_new(dst1, src1 + SAO_SRC_OFFSET, SAO_DST_STRIDE, offset_val, eo, size, size);
+                check_mc_rows(dst0, dst1, SAO_DST_STRIDE, size * SIZEOF_PIXEL);
+                bench_new(dst1, src1 + SAO_SRC_OFFSET, SAO_DST_STRIDE, offset_val, eo, size, size);
+            }
+        }
+    }
+    report("sao_edge");
+}
+
+/* Fill an 8-line edge segment with a smooth ramp plus small noise so that
+ * the filter decisions actually take the weak and strong paths. */
+#define DB_STRIDE 64
+#define DB_SIZE   (DB_STRIDE * 16)
+
+static void randomize_deblock_buffers(uint8_t *buf0, uint8_t *buf1, int bit_depth)
+{
+    int base  = rnd() & PIXEL_MASK;
+    int slope = (int)(rnd() % 9) - 4;
+    int x, y;
+
+    for (y = 0; y < 16; y++)
+        for (x = 0; x < DB_STRIDE / 2; x++) {
+            int v = av_clip(base + slope * ((x + y) << (bit_depth - 8)) +
+                            (int)(rnd() % 5) - 2, 0, PIXEL_MASK);
+            if (bit_depth == 8) {
+                buf0[y * DB_STRIDE + x] = v;
+                buf0[y * DB_STRIDE + x + DB_STRIDE / 2] = rnd();
+            } else {
+                AV_WN16A(buf0 + y * DB_STRIDE + 2 * x, v);
+            }
+        }
+    memcpy(buf1, buf0, DB_SIZE);
+}
+
+static void check_deblock(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf0, [DB_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [DB_SIZE]);
+    uint8_t no_p[2] = { 0, 0 }, no_q[2] = { 0, 0 };
+    int32_t tc[2];
+    HEVCDSPContext h;
+    int d, dir;
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (dir = 0; dir < 2; dir++) {
+            /* horizontal edges sit between rows 7 and 8, vertical ones between columns 3 and 4 */
+            int off = dir ? 8 * DB_STRIDE : 4 * SIZEOF_PIXEL;
+            declare_func(void, uint8_t *pix, ptrdiff_t stride, int beta, int32_t *tc,
+                         uint8_t *no_p, uint8_t *no_q);
+
+            if (check_func(dir ? h.hevc_h_loop_filter_luma : h.hevc_v_loop_filter_luma,
+                           "hevc_%s_loop_filter_luma_%d", dir ? "h" : "v", bit_depth)) {
+                int beta = rnd() % 65;
+                tc[0] = rnd() % 25;
+                tc[1] = rnd() % 25;
+                randomize_deblock_buffers(buf0, buf1, bit_depth);
+                call_ref(buf0 + off, DB_STRIDE, beta, tc, no_p, no_q);
+                call_new(buf1 + off, DB_STRIDE, beta, tc, no_p, no_q);
+                if (memcmp(buf0, buf1, DB_SIZE))
+                    fail();
+                bench_new(buf1 + off, DB_STRIDE, beta, tc, no_p, no_q);
+            }
+        }
+    }
+    report("deblock_luma");
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (dir = 0; dir < 2; dir++) {
+            int off = dir ? 8 * DB_STRIDE : 4 * SIZEOF_PIXEL;
+            declare_func(void, uint8_t *pix, ptrdiff_t stride, int32_t *tc,
+                         uint8_t *no_p, uint8_t *no_q);
+
+            if (check_func(dir ? h.hevc_h_loop_filter_chroma : h.hevc_v_loop_filter_chroma,
+                           "hevc_%s_loop_filter_chroma_%d", dir ? "h" : "v", bit_depth)) {
+                tc[0] = rnd() % 25;
+                tc[1] = rnd() % 25;
+                randomize_deblock_buffers(buf0, buf1, bit_depth);
+                call_ref(buf0 + off, DB_STRIDE, tc, no_p, no_q);
+                call_new(buf1 + off, DB_STRIDE, tc, no_p, no_q);
+                if (memcmp(buf0, buf1, DB_SIZE))
+                    fail();
+                bench_new(buf1 + off, DB_STRIDE, tc, no_p, no_q);
+            }
+        }
+    }
+    report("deblock_chroma");
+}
+
+static void check_idct(void)
+{
+    LOCAL_ALIGNED_32(int16_t, coeffs0, [32 * 32]);
+    LOCAL_ALIGNED_32(int16_t, coeffs1, [32 * 32]);
+    HEVCDSPContext h;
+    int d, i, k;
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (i = 0; i < 4; i++) {
+            int size = 4 << i;
+            declare_func(void, int16_t *coeffs, int col_limit);
+
+            if (check_func(h.idct[i], "hevc_idct_%dx%d_%d", size, size, bit_depth)) {
+                for (k = 0; k < size * size; k++)
+                    coeffs0[k] = (int)(rnd() % 1024) - 512;
+                memcpy(coeffs1, coeffs0, sizeof(*coeffs0) * size * size);
+                call_ref(coeffs0, size);
+                call_new(coeffs1, size);
+                if (memcmp(coeffs0, coeffs1, sizeof(*coeffs0) * size * size))
+                    fail();
+                bench_new(coeffs1, size);
+            }
+        }
+    }
+    report("idct");
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (i = 0; i < 4; i++) {
+            int size = 4 << i;
+            declare_func(void, int16_t *coeffs);
+
+            if (check_func(h.idct_dc[i], "hevc_idct_%dx%d_dc_%d", size, size, bit_depth)) {
+                for (k = 0; k < size * size; k++)
+                    coeffs0[k] = rnd();
+                memcpy(coeffs1, coeffs0, sizeof(*coeffs0) * size * size);
+                call_ref(coeffs0);
+                call_new(coeffs1);
+                if (memcmp(coeffs0, coeffs1, sizeof(*coeffs0) * size * size))
+                    fail();
+                bench_new(coeffs1);
+            }
+        }
+    }
+    report("idct_dc");
+}
+
+static void check_transform_add(void)
+{
+    LOCAL_ALIGNED_32(int16_t, res0, [32 * 32]);
+    LOCAL_ALIGNED_32(int16_t, res1, [32 * 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [32 * 32 * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [32 * 32 * 2]);
+    HEVCDSPContext h;
+    int d, i, k;
+
+    for (d = 0; d < FF_ARRAY_ELEMS(bit_depths); d++) {
+        int bit_depth = bit_depths[d];
+        ff_hevc_dsp_init(&h, bit_depth);
+        for (i = 0; i < 4; i++) {
+            int size = 4 << i;
+            declare_func(void, uint8_t *dst, int16_t *res, ptrdiff_t stride);
+
+            if (check_func(h.transform_add[i], "hevc_add_res_%dx%d_%d", size, size, bit_depth)) {
+                for (k = 0; k < size * size; k++)
+                    res0[k] = (int16_t)rnd() >> 3;
+                memcpy(res1, res0, sizeof(*res0) * size * size);
+                randomize_pixels(dst0, size * size, bit_depth);
+                memcpy(dst1, dst0, size * size * SIZEOF_PIXEL);
+                call_ref(dst0, res0, size * SIZEOF_PIXEL);
+                call_new(dst1, res1, size * SIZEOF_PIXEL);
+                if (memcmp(dst0, dst1, size * size * SIZEOF_PIXEL))
+                    fail();
+                bench_new(dst1, res1, size * SIZEOF_PIXEL);
+            }
+        }
+    }
+    report("add_res");
+}
+
+void checkasm_check_hevcdsp(void)
+{
+    check_mc();
+    check_mc_uni();
+    check_mc_uni_w();
+    check_mc_bi();
+    check_mc_bi_w();
+    check_sao();
+    check_deblock();
+    check_idct();
+    check_transform_add();
+}
@@ -0,0 +1,253 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#define DST_W       90          /* not a multiple of any SIMD width */
+#define SRC_W       (2 * DST_W)
+#define MAX_HFILTER 40
+#define MAX_VFILTER 16
+#define LINE_SIZE   FFALIGN((DST_W + 32) * 4, 32)
+
+static const int hfilter_sizes[] = { 4, 8, 12, 16, 24, 40 };
+static const int vfilter_sizes[] = { 2, 4, 6, 8, 16 };
+
+static SwsContext *alloc_context(enum AVPixelFormat src_fmt,
+                                 enum AVPixelFormat dst_fmt)
+{
+    /* SWS_BITEXACT keeps the inline asm vertical scaler, which rounds
+     * differently from the C code, out of the way. */
+    return sws_getContext(SRC_W, 16, src_fmt, DST_W, 16, dst_fmt,
+                          SWS_BILINEAR | SWS_BITEXACT, NULL, NULL, NULL);
+}
+
+/* Random coefficients with sum 1 << bits, like the filters of initFilter() */
+static void randomize_filter(int16_t *filter, int size, int bits, int range)
+{
+    int j, sum = 0;
+
+    for (j = 0; j < size; j++) {
+        filter[j] = (int)(rnd() % (2 * range)) - range;
+        sum      += filter[j];
+    }
+    j          = rnd() % size;
+    filter[j] += (1 << bits) - sum;
+}
+
+static void check_hscale(void)
+{
+    static const enum AVPixelFormat src_fmts[] = {
+        AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P10LE,
+        AV_PIX_FMT_YUV420P12LE, AV_PIX_FMT_YUV420P16LE,
+    };
+    static const enum AVPixelFormat dst_fmts[] = {
+        AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P16LE,
+    };
+    LOCAL_ALIGNED_32(uint16_t, src, [SRC_W + MAX_HFILTER]);
+    LOCAL_ALIGNED_32(int32_t, dst0, [DST_W + 8]);
+    LOCAL_ALIGNED_32(int32_t, dst1, [DST_W + 8]);
+    LOCAL_ALIGNED_32(int16_t, filter, [(DST_W + 3) * MAX_HFILTER]);
+    LOCAL_ALIGNED_32(int32_t, filter_pos, [DST_W + 3]);
+    int i, f, s, d;
+
+    declare_func(void, SwsContext *c, int16_t *dst, int dstW,
+                 const uint8_t *src, const int16_t *filter,
+                 const int32_t *filterPos, int filterSize);
+
+    for (s = 0; s < FF_ARRAY_ELEMS(src_fmts); s++) {
+        int depth = av_pix_fmt_desc_get(src_fmts[s])->comp[0].depth;
+
+        if (depth == 8) {
+            for (i = 0; i < SRC_W + MAX_HFILTER; i++)
+                ((uint8_t *)src)[i] = rnd();
+        } else {
+            for (i = 0; i < SRC_W + MAX_HFILTER; i++)
+                src[i] = rnd() & ((1 << depth) - 1);
+        }
+
+        for (d = 0; d < FF_ARRAY_ELEMS(dst_fmts); d++) {
+            SwsContext *c = alloc_context(src_fmts[s], dst_fmts[d]);
+            int out_bits;
+
+            if (!c)
+                return;
+            out_bits = c->dstBpc > 14 ? 19 : 15;
+
+            for (f = 0; f < FF_ARRAY_ELEMS(hfilter_sizes); f++) {
+                int size = hfilter_sizes[f];
+
+                c->hLumFilterSize = c->hChrFilterSize = size;
+                ff_getSwsFunc(c);
+                if (!check_func(c->hyScale, "hscale_%d_to_%d_%d",
+                                depth, out_bits, size))
+                    continue;
+
+                for (i = 0; i < DST_W; i++) {
+                    filter_pos[i] = rnd() % (SRC_W - size + 1);
+                    randomize_filter(filter + i * size, size, 14, 64);
+                }
+                /* the SIMD versions read up to 3 entries past the end */
+                for (; i < DST_W + 3; i++) {
+                    filter_pos[i] = filter_pos[DST_W - 1];
+                    memcpy(filter + i * size, filter + (DST_W - 1) * size,
+                           size * sizeof(*filter));
+                }
+
+                memset(dst0, 0, sizeof(*dst0) * (DST_W + 8));
+                memset(dst1, 0, sizeof(*dst1) * (DST_W + 8));
+                call_ref(c, (int16_t *)dst0, DST_W, (const uint8_t *)src,
+                         filter, filter_pos, size);
+                call_new(c, (int16_t *)dst1, DST_W, (const uint8_t *)src,
+                         filter, filter_pos, size);
+                if (memcmp(dst0, dst1, DST_W * (out_bits == 19 ? 4 : 2)))
+                    fail();
+                bench_new(c, (int16_t *)dst1, DST_W, (const uint8_t *)src,
+                          filter, filter_pos, size);
+            }
+            sws_freeContext(c);
+        }
+    }
+}
+
+static const enum AVPixelFormat vscale_fmts[] = {
+    AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P9LE,
+    AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV420P16LE,
+};
+
+static void randomize_lines(uint8_t *buf, int nb_lines, int depth)
+{
+    int i;
+
+    for (i = 0; i < nb_lines * LINE_SIZE; i += 4) {
+        if (depth == 16) /* 19 bit intermediates in int32_t */
+            AV_WN32A(buf + i, rnd() & 0x7ffff);
+        else
+            AV_WN32A(buf + i, rnd());
+    }
+}
+
+static void check_yuv2plane1(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [LINE_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [LINE_SIZE + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [LINE_SIZE + 32]);
+    uint8_t dither[8];
+    int i, d, offset;
+
+    declare_func(void, const int16_t *src, uint8_t *dest, int dstW,
+                 const uint8_t *dither, int offset);
+
+    for (d = 0; d < FF_ARRAY_ELEMS(vscale_fmts); d++) {
+        SwsContext *c = alloc_context(AV_PIX_FMT_YUV420P, vscale_fmts[d]);
+        int depth, bytes;
+
+        if (!c)
+            return;
+        depth = c->dstBpc;
+        bytes = depth > 8 ? 2 : 1;
+
+        if (check_func(c->yuv2plane1, "yuv2plane1_%d", depth)) {
+            for (offset = 0; offset <= 3; offset += 3) {
+                /* the second pass uses a misaligned destination */
+                int misalign = offset ? bytes : 0;
+
+                randomize_lines(src, 1, depth);
+                for (i = 0; i < 8; i++)
+                    dither[i] = rnd();
+                memset(dst0, 0, LINE_SIZE + 32);
+                memset(dst1, 0, LINE_SIZE + 32);
+                call_ref((const int16_t *)src, dst0 + misalign, DST_W, dither, offset);
+                call_new((const int16_t *)src, dst1 + misalign, DST_W, dither, offset);
+                if (memcmp(dst0 + misalign, dst1 + misalign, DST_W * bytes))
+                    fail();
+            }
+            bench_new((const int16_t *)src, dst1, DST_W, dither, 0);
+        }
+        sws_freeContext(c);
+    }
+}
+
+static void check_yuv2planeX(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [MAX_VFILTER * LINE_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [LINE_SIZE + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [LINE_SIZE + 32]);
+    LOCAL_ALIGNED_16(int16_t, filter, [MAX_VFILTER]);
+    const int16_t *lines[MAX_VFILTER];
+    uint8_t dither[8];
+    int i, d, f, offset;
+
+    declare_func(void, const int16_t *filter, int filterSize,
+                 const int16_t **src, uint8_t *dest, int dstW,
+                 const uint8_t *dither, int offset);
+
+    for (i = 0; i < MAX_VFILTER; i++)
+        lines[i] = (const int16_t *)(src + i * LINE_SIZE);
+
+    for (d = 0; d < FF_ARRAY_ELEMS(vscale_fmts); d++) {
+        SwsContext *c = alloc_context(AV_PIX_FMT_YUV420P, vscale_fmts[d]);
+        int depth, bytes;
+
+        if (!c)
+            return;
+        depth = c->dstBpc;
+        bytes = depth > 8 ? 2 : 1;
+
+        if (check_func(c->yuv2planeX, "yuv2planeX_%d", depth)) {
+            for (f = 0; f < FF_ARRAY_ELEMS(vfilter_sizes); f++) {
+                int size = vfilter_sizes[f];
+
+                for (offset = 0; offset <= 3; offset += 3) {
+                    int misalign = offset ? bytes : 0;
+
+                    randomize_lines(src, size, depth);
+                    randomize_filter(filter, size, 12, 256);
+                    for (i = 0; i < 8; i++)
+                        dither[i] = rnd();
+                    memset(dst0, 0, LINE_SIZE + 32);
+                    memset(dst1, 0, LINE_SIZE + 32);
+                    call_ref(filter, size, lines, dst0 + misalign, DST_W, dither, offset);
+                    call_new(filter, size, lines, dst1 + misalign, DST_W, dither, offset);
+                    if (memcmp(dst0 + misalign, dst1 + misalign, DST_W * bytes))
+                        fail();
+                }
+            }
+            bench_new(filter, 4, lines, dst1, DST_W, dither, 0);
+        }
+        sws_freeContext(c);
+    }
+}
+
+void checkasm_check_sw_scale(void)
+{
+    check_hscale();
+    report("hscale");
+    check_yuv2plane1();
+    report("yuv2plane1");
+    check_yuv2planeX();
+    report("yuv2planeX");
+}
@@ -293,6 +293,15 @@ audio_match(){
     tests/audiomatch $decfile $trefile
 }
 
+seek_nocues(){
+    file="${outdir}/${test}.mkv"
+    cleanfiles="$cleanfiles $file"
+
+    # written to a pipe, so that the muxer leaves out the Cues
+    ffmpeg "$@" -flags +bitexact -fflags +bitexact -f matroska pipe: > "$file"
+    run libavformat/tests/seek "$(target_path $file)" -duration 10
+}
+
 concat(){
     template=$1
     sample=$2
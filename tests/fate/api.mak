@@ -34,6 +34,10 @@ fate-api-threadmessage: CMD = run $(APITESTSDIR)/api-threadmessage-test 3 10 30
 fate-api-threadmessage: CMP = null
 fate-api-threadmessage: REF = /dev/null
 
+FATE_API_LIBAVFORMAT-$(call ALLYES, SHM_INDEV SHM_OUTDEV) += fate-api-shm
+fate-api-shm: $(APITESTSDIR)/api-shm-test$(EXESUF)
+fate-api-shm: CMD = run $(APITESTSDIR)/api-shm-test
+
 FATE_API_SAMPLES-$(CONFIG_AVFORMAT) += $(FATE_API_SAMPLES_LIBAVFORMAT-yes)
 
 ifdef SAMPLES
@@ -25,6 +25,10 @@ fate-ffmpeg-filter_colorkey: CMD = framecrc -idct simple -fflags +bitexact -flag
 FATE_FFMPEG-$(CONFIG_COLOR_FILTER) += fate-ffmpeg-lavfi
 fate-ffmpeg-lavfi: CMD = framecrc -lavfi color=d=1:r=5 -fflags +bitexact
 
+# more frames in flight than the encoder has threads and ring slots
+FATE_FFMPEG-$(call ALLYES, LAVFI_INDEV TESTSRC_FILTER PNG_ENCODER) += fate-ffmpeg-frame_thread_depth
+fate-ffmpeg-frame_thread_depth: CMD = framecrc -f lavfi -i testsrc=s=32x32:r=25:d=16 -threads 2 -thread_type frame -frame_thread_depth 1000 -c:v png
+
 FATE_SAMPLES_FFMPEG-$(CONFIG_RAWVIDEO_DEMUXER) += fate-force_key_frames
 fate-force_key_frames: tests/data/vsynth_lena.yuv
 fate-force_key_frames: CMD = enc_dec \
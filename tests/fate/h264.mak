@@ -213,6 +213,14 @@ FATE_H264-$(call DEMDEC, MOV, H264) += fate-h264-attachment-631
 FATE_H264-$(call DEMDEC, MPEGTS, H264) += fate-h264-skip-nokey fate-h264-skip-nointra
 FATE_H264_FFPROBE-$(call DEMDEC, MATROSKA, H264) += fate-h264-dts_5frames
 
+# single slice pictures decoded with two slice threads are deblocked by the
+# second thread, the output must match the single threaded references
+FATE_H264_SLICE_THREADS := caba1_sva_b                                  \
+                           caba3_sva_b                                  \
+                           sva_ba1_b                                    \
+
+FATE_H264-$(call DEMDEC, H264, H264) += $(FATE_H264_SLICE_THREADS:%=fate-h264-slice-threads-%)
+
 FATE_SAMPLES_AVCONV += $(FATE_H264-yes)
 FATE_SAMPLES_FFPROBE += $(FATE_H264_FFPROBE-yes)
 fate-h264: $(FATE_H264-yes) $(FATE_H264_FFPROBE-yes)
@@ -420,6 +428,13 @@ fate-h264-invalid-ref-mod:                        CMD = framecrc -i $(TARGET_SAM
 fate-h264-unescaped-extradata:                    CMD = framecrc -i $(TARGET_SAMPLES)/h264/unescaped_extradata.mp4 -an -frames 10
 fate-h264-3386:                                   CMD = framecrc -i $(TARGET_SAMPLES)/h264/bbc2.sample.h264
 
+fate-h264-slice-threads-%: THREADS = 2
+fate-h264-slice-threads-%: THREAD_TYPE = slice
+fate-h264-slice-threads-%: REF = $(SRC_PATH)/tests/ref/fate/$(@:fate-h264-slice-threads-%=h264-conformance-%)
+fate-h264-slice-threads-caba1_sva_b:              CMD = framecrc -i $(TARGET_SAMPLES)/h264-conformance/CABA1_SVA_B.264
+fate-h264-slice-threads-caba3_sva_b:              CMD = framecrc -i $(TARGET_SAMPLES)/h264-conformance/CABA3_SVA_B.264
+fate-h264-slice-threads-sva_ba1_b:                CMD = framecrc -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/SVA_BA1_B.264
+
 fate-h264-reinit-%:                               CMD = framecrc -i $(TARGET_SAMPLES)/h264/$(@:fate-h264-%=%).h264 -vf format=yuv444p10le,scale=w=352:h=288
 
 fate-h264-dts_5frames:                            CMD = probeframes $(TARGET_SAMPLES)/h264/dts_5frames.mkv
@@ -254,6 +254,12 @@ fate-seek-mkv-codec-delay:   CMD = run libavformat/tests/seek$(EXESUF) $(TARGET_
 
 FATE_SEEK_EXTRA += $(FATE_SEEK_EXTRA-yes)
 
+# seeking past the index of a file without Cues bisects the Clusters
+FATE_SEEK_NOCUES-$(call ENCDEC, FFV1 PGMYUV, MATROSKA IMAGE2) += fate-seek-mkv-no-cues
+fate-seek-mkv-no-cues: libavformat/tests/seek$(EXESUF) $(VREF)
+fate-seek-mkv-no-cues: CMD = seek_nocues -framerate 10 -loop 1 -f image2 -c:v pgmyuv -i $(TARGET_PATH)/tests/vsynth1/%02d.pgm -frames:v 100 -c:v ffv1 -g 10
+FATE_AVCONV += $(FATE_SEEK_NOCUES-yes)
+
 
 $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA): libavformat/tests/seek$(EXESUF)
 $(FATE_SEEK) $(FATE_SAMPLES_SEEK): CMD = run libavformat/tests/seek$(EXESUF) $(TARGET_PATH)/tests/data/$(SRC)
@@ -262,4 +268,4 @@ fate-seek-%: REF = $(SRC_PATH)/tests/ref/seek/$(@:fate-seek-%=%)
 
 FATE_AVCONV += $(FATE_SEEK)
 FATE_SAMPLES_AVCONV += $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
-fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
+fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA) $(FATE_SEEK_NOCUES-yes)
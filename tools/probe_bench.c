@@ -0,0 +1,103 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure the time spent in format probing for a set of files, e.g.
+ *   find fate-suite -type f | xargs tools/probe_bench -n 10
+ * The probe buffer grows the same way as in av_probe_input_buffer2().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavformat/avformat.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+
+#define PROBE_BUF_MIN 2048
+#define PROBE_BUF_MAX (1 << 20)
+
+static int probe_file(const char *filename, int runs, int64_t *total)
+{
+    AVProbeData pd = { 0 };
+    AVInputFormat *fmt = NULL;
+    FILE *f = fopen(filename, "rb");
+    uint8_t *buf;
+    int size, probe_size, score = 0, run;
+    int64_t t;
+
+    if (!f) {
+        fprintf(stderr, "Cannot open %s\n", filename);
+        return -1;
+    }
+    buf = av_mallocz(PROBE_BUF_MAX + AVPROBE_PADDING_SIZE);
+    if (!buf) {
+        fclose(f);
+        return AVERROR(ENOMEM);
+    }
+    size = fread(buf, 1, PROBE_BUF_MAX, f);
+    fclose(f);
+
+    pd.filename = filename;
+    pd.buf      = buf;
+
+    t = av_gettime_relative();
+    for (run = 0; run < runs; run++) {
+        for (probe_size = PROBE_BUF_MIN; ; probe_size = FFMIN(probe_size << 1, PROBE_BUF_MAX)) {
+            pd.buf_size = FFMIN(probe_size, size);
+            score       = probe_size < PROBE_BUF_MAX ? AVPROBE_SCORE_RETRY : 0;
+            fmt         = av_probe_input_format2(&pd, 1, &score);
+            if (fmt || probe_size >= FFMIN(PROBE_BUF_MAX, size))
+                break;
+        }
+    }
+    t = av_gettime_relative() - t;
+    *total += t;
+
+    printf("%10.1f us %-16s %3d %7d %s\n", (double)t / runs,
+           fmt ? fmt->name : "-", score, pd.buf_size, filename);
+
+    av_free(buf);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int64_t total = 0;
+    int runs = 1, i = 1, nb_files = 0;
+
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+        runs = FFMAX(atoi(argv[2]), 1);
+        i    = 3;
+    }
+    if (i >= argc) {
+        fprintf(stderr, "usage: %s [-n runs] file...\n", argv[0]);
+        return 1;
+    }
+
+    av_register_all();
+
+    for (; i < argc; i++)
+        if (probe_file(argv[i], runs, &total) >= 0)
+            nb_files++;
+
+    printf("%d files, %.1f us per file\n", nb_files,
+           nb_files ? (double)total / runs / nb_files : 0);
+    return 0;
+}